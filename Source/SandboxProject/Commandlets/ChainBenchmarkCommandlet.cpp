@@ -0,0 +1,376 @@
+// This is Sandbox Project.
+
+#include "ChainBenchmarkCommandlet.h"
+#include "SandboxProject/Components/ChainComponent.h"
+#include "SandboxProject/Components/SplineChainComponent.h"
+#include "SandboxProject/Components/ChainStats.h"
+#include "Components/SplineComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Dom/JsonObject.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/UObjectGlobals.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(ChainBenchmarkLog, All, All);
+
+namespace ChainBenchmark
+{
+	/** Step time of every benchmark frame. */
+	constexpr float FrameTime = 1.0f / 60.0f;
+
+	/** Distance between two chain points along the initial line. */
+	constexpr float PointSpacing = 10.0f;
+
+	/** Depth of the collision floor below the chain starts. */
+	constexpr float FloorDepth = 200.0f;
+
+	/** Mesh of the chain links and the collision floor, part of the engine content. */
+	static const TCHAR* MeshPath = TEXT("/Engine/BasicShapes/Cube.Cube");
+
+	/**
+	 * Allocator that forwards to the one it wraps and counts the allocations made on the game thread.
+	 * Installed as GMalloc around the measured frames only. Blocks allocated through it belong to the wrapped
+	 * allocator, so they are freed correctly once it is removed again.
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			// Growing or creating a block counts, shrinking and freeing through Realloc do not.
+			SIZE_T OriginalSize = 0;
+			if (Count > 0 && (! Original || ! Inner->GetAllocationSize(Original, OriginalSize) || Count > OriginalSize))
+			{
+				CountAllocation();
+			}
+
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("ChainBenchmarkCountingMalloc"); }
+
+		/**
+		 * @return The number of allocations counted so far.
+		 */
+		uint64 GetNumAllocations() const { return NumAllocations.load(std::memory_order_relaxed); }
+
+	private:
+		void CountAllocation()
+		{
+			// Chains are stepped on the game thread, allocations of other threads are not theirs.
+			if (IsInGameThread())
+			{
+				NumAllocations.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		/** The allocator every call is forwarded to. */
+		FMalloc* Inner;
+
+		/** Allocations made on the game thread since the allocator was created. */
+		std::atomic<uint64> NumAllocations{0};
+	};
+}
+
+UChainBenchmarkCommandlet::UChainBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UChainBenchmarkCommandlet::Main(const FString& Params)
+{
+	FCase BaseCase;
+	FParse::Value(*Params, TEXT("Chains="), BaseCase.NumChains);
+	FParse::Value(*Params, TEXT("Stiffness="), BaseCase.Stiffness);
+	FParse::Value(*Params, TEXT("Frames="), BaseCase.Frames);
+	FParse::Value(*Params, TEXT("Warmup="), BaseCase.WarmupFrames);
+	BaseCase.bSpline = FParse::Param(*Params, TEXT("Spline"));
+	BaseCase.bCollision = FParse::Param(*Params, TEXT("Collision"));
+	BaseCase.bSelfCollision = FParse::Param(*Params, TEXT("SelfCollision"));
+	BaseCase.bCable = FParse::Param(*Params, TEXT("Cable"));
+
+	BaseCase.NumChains = FMath::Max(BaseCase.NumChains, 1);
+	BaseCase.Frames = FMath::Max(BaseCase.Frames, 1);
+	BaseCase.WarmupFrames = FMath::Max(BaseCase.WarmupFrames, 0);
+
+	FString BackendName = TEXT("Scalar");
+	FParse::Value(*Params, TEXT("Backend="), BackendName);
+	BaseCase.Backend = StaticEnum<EChainSolverBackend>()->GetValueByNameString(BackendName);
+
+	if (BaseCase.Backend == INDEX_NONE)
+	{
+		UE_LOG(ChainBenchmarkLog, Error, TEXT("Unknown solver backend '%s'."), *BackendName);
+		return 1;
+	}
+
+	FString SegmentList = TEXT("16,64,256");
+	FParse::Value(*Params, TEXT("Segments="), SegmentList, false);
+
+	TArray<FString> SegmentStrings;
+	SegmentList.ParseIntoArray(SegmentStrings, TEXT(","));
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("ChainBenchmark-%s"), *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	BenchmarkMesh = LoadObject<UStaticMesh>(nullptr, ChainBenchmark::MeshPath);
+
+	TArray<FResult> Results;
+
+	for (const FString& SegmentString : SegmentStrings)
+	{
+		FCase Case = BaseCase;
+		Case.Segments = FMath::Max(FCString::Atoi(*SegmentString), 2);
+
+		const FResult& Result = Results.Add_GetRef(RunCase(Case));
+
+		UE_LOG(ChainBenchmarkLog, Display, TEXT("%d chains x %d segments: %.3f ms per frame, %llu bytes of chain buffers"), Case.NumChains, Case.Segments, Result.TotalMs, static_cast<uint64>(Result.ChainBytes));
+
+		for (int32 Phase = 0; Phase < static_cast<int32>(EChainPhase::Num); Phase++)
+		{
+			UE_LOG(ChainBenchmarkLog, Display, TEXT("    %-12s %.3f ms"), FChainPhaseTimings::GetPhaseName(static_cast<EChainPhase>(Phase)), Result.PhaseMs[Phase]);
+		}
+	}
+
+	WriteReports(Results, OutputPath);
+
+	return 0;
+}
+
+UChainBenchmarkCommandlet::FResult UChainBenchmarkCommandlet::RunCase(const FCase& Case)
+{
+	FResult Result;
+	Result.Case = Case;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ChainBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+
+	if (Case.bCollision && BenchmarkMesh)
+	{
+		AStaticMeshActor* Floor = World->SpawnActor<AStaticMeshActor>(FVector(0.0f, 0.0f, -ChainBenchmark::FloorDepth), FRotator::ZeroRotator);
+		Floor->SetMobility(EComponentMobility::Movable);
+		Floor->GetStaticMeshComponent()->SetStaticMesh(BenchmarkMesh);
+		Floor->SetActorScale3D(FVector(1000.0f, 1000.0f, 1.0f));
+
+		// Flushes the floor into the scene queries before the first sweep.
+		World->Tick(LEVELTICK_All, ChainBenchmark::FrameTime);
+	}
+
+	// Chains are laid out on a grid far enough apart to never touch each other.
+	const int32 GridSize = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(Case.NumChains)));
+	const float GridSpacing = Case.Segments * ChainBenchmark::PointSpacing * 2.0f;
+
+	TArray<UChainComponent*> Chains;
+	Chains.Reserve(Case.NumChains);
+
+	for (int32 i = 0; i < Case.NumChains; i++)
+	{
+		Chains.Add(SpawnChain(World, Case, FVector((i % GridSize) * GridSpacing, (i / GridSize) * GridSpacing, 0.0f)));
+	}
+
+	TArray<FChainPhaseTimings> Timings;
+	Timings.SetNum(Chains.Num());
+
+	for (int32 i = 0; i < Chains.Num(); i++)
+	{
+		Chains[i]->SetPhaseTimings(&Timings[i]);
+	}
+
+	uint64 StartCycles = 0;
+
+	FMalloc* const DefaultMalloc = GMalloc;
+	ChainBenchmark::FCountingMalloc CountingMalloc(DefaultMalloc);
+
+	for (int32 Frame = 0; Frame < Case.WarmupFrames + Case.Frames; Frame++)
+	{
+		if (Frame == Case.WarmupFrames)
+		{
+			for (FChainPhaseTimings& ChainTimings : Timings)
+			{
+				ChainTimings = FChainPhaseTimings();
+			}
+
+			GMalloc = &CountingMalloc;
+			StartCycles = FPlatformTime::Cycles64();
+		}
+
+		World->TimeSeconds += ChainBenchmark::FrameTime;
+
+		for (UChainComponent* Chain : Chains)
+		{
+			Chain->StepChain(ChainBenchmark::FrameTime);
+		}
+	}
+
+	Result.TotalMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) / Case.Frames;
+	GMalloc = DefaultMalloc;
+	Result.SteppingAllocations = CountingMalloc.GetNumAllocations();
+
+	FChainPhaseTimings TotalTimings;
+
+	for (int32 i = 0; i < Chains.Num(); i++)
+	{
+		TotalTimings.Accumulate(Timings[i]);
+		Chains[i]->SetPhaseTimings(nullptr);
+
+		FResourceSizeEx ResourceSize(EResourceSizeMode::Exclusive);
+		Chains[i]->GetResourceSizeEx(ResourceSize);
+		Result.ChainBytes += ResourceSize.GetTotalMemoryBytes();
+	}
+
+	for (int32 Phase = 0; Phase < static_cast<int32>(EChainPhase::Num); Phase++)
+	{
+		Result.PhaseMs.Add(TotalTimings.GetMilliseconds(static_cast<EChainPhase>(Phase)) / Case.Frames);
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	return Result;
+}
+
+UChainComponent* UChainBenchmarkCommandlet::SpawnChain(UWorld* World, const FCase& Case, const FVector& Location)
+{
+	AActor* Actor = World->SpawnActor<AActor>();
+
+	USceneComponent* Root = NewObject<USceneComponent>(Actor, TEXT("Root"));
+	Actor->SetRootComponent(Root);
+	Root->SetWorldLocation(Location);
+	Root->RegisterComponent();
+
+	const float Length = Case.Segments * ChainBenchmark::PointSpacing;
+
+	if (Case.bSpline)
+	{
+		USplineComponent* Spline = NewObject<USplineComponent>(Actor, TEXT("Spline"));
+		Spline->SetupAttachment(Root);
+		Spline->RegisterComponent();
+		Spline->SetSplinePoints({FVector::ZeroVector, FVector(Length * 0.5f, 0.0f, -Length * 0.2f), FVector(Length, 0.0f, 0.0f)}, ESplineCoordinateSpace::Local);
+	}
+
+	UChainComponent* Chain = Case.bSpline ? NewObject<USplineChainComponent>(Actor, TEXT("Chain")) : NewObject<UChainComponent>(Actor, TEXT("Chain"));
+
+	// Every chain steps every frame at full detail, on the game thread.
+	Chain->bUseSimulationSubsystem = false;
+	Chain->bUseSignificance = false;
+	Chain->bAllowSleep = false;
+	Chain->bUseRestPose = false;
+
+	Chain->Segments = Case.Segments;
+	Chain->Stiffness = Case.Stiffness;
+	Chain->SolverBackend = static_cast<EChainSolverBackend>(Case.Backend);
+	Chain->bSelfCollision = Case.bSelfCollision;
+	Chain->RenderMode = Case.bCable ? EChainRenderMode::Cable : EChainRenderMode::Instances;
+	Chain->ChainMesh = BenchmarkMesh;
+	Chain->Scale = FVector(0.05f);
+	Chain->bIsLocal = true;
+	Chain->EndPoint = FVector(Length, 0.0f, 0.0f);
+	Chain->AttachEnd = false;
+	Chain->SetCollisionEnabled(Case.bCollision ? ECollisionEnabled::QueryOnly : ECollisionEnabled::NoCollision);
+
+	Chain->SetupAttachment(Root);
+	Chain->RegisterComponent();
+	Chain->SetComponentTickEnabled(false);
+
+	return Chain;
+}
+
+void UChainBenchmarkCommandlet::WriteReports(const TArray<FResult>& Results, const FString& OutputPath) const
+{
+	const UEnum* BackendEnum = StaticEnum<EChainSolverBackend>();
+
+	FString Csv = TEXT("Type,Backend,Chains,Segments,Stiffness,Collision,SelfCollision,Render,Frames");
+	for (int32 Phase = 0; Phase < static_cast<int32>(EChainPhase::Num); Phase++)
+	{
+		Csv += FString::Printf(TEXT(",%sMs"), FChainPhaseTimings::GetPhaseName(static_cast<EChainPhase>(Phase)));
+	}
+	Csv += TEXT(",TotalMs,ChainBytes,SteppingAllocations\n");
+
+	TArray<TSharedPtr<FJsonValue>> JsonCases;
+
+	for (const FResult& Result : Results)
+	{
+		const FCase& Case = Result.Case;
+		const FString Type = Case.bSpline ? TEXT("SplineChain") : TEXT("Chain");
+		const FString Backend = BackendEnum->GetNameStringByValue(Case.Backend);
+		const FString Render = Case.bCable ? TEXT("Cable") : TEXT("Instances");
+
+		Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%d,%d,%s,%d"), *Type, *Backend, Case.NumChains, Case.Segments, Case.Stiffness, Case.bCollision, Case.bSelfCollision, *Render, Case.Frames);
+
+		TSharedRef<FJsonObject> JsonCase = MakeShared<FJsonObject>();
+		JsonCase->SetStringField(TEXT("Type"), Type);
+		JsonCase->SetStringField(TEXT("Backend"), Backend);
+		JsonCase->SetNumberField(TEXT("Chains"), Case.NumChains);
+		JsonCase->SetNumberField(TEXT("Segments"), Case.Segments);
+		JsonCase->SetNumberField(TEXT("Stiffness"), Case.Stiffness);
+		JsonCase->SetBoolField(TEXT("Collision"), Case.bCollision);
+		JsonCase->SetBoolField(TEXT("SelfCollision"), Case.bSelfCollision);
+		JsonCase->SetStringField(TEXT("Render"), Render);
+		JsonCase->SetNumberField(TEXT("Frames"), Case.Frames);
+
+		TSharedRef<FJsonObject> JsonPhases = MakeShared<FJsonObject>();
+
+		for (int32 Phase = 0; Phase < static_cast<int32>(EChainPhase::Num); Phase++)
+		{
+			Csv += FString::Printf(TEXT(",%.4f"), Result.PhaseMs[Phase]);
+			JsonPhases->SetNumberField(FChainPhaseTimings::GetPhaseName(static_cast<EChainPhase>(Phase)), Result.PhaseMs[Phase]);
+		}
+
+		Csv += FString::Printf(TEXT(",%.4f,%llu,%llu\n"), Result.TotalMs, static_cast<uint64>(Result.ChainBytes), Result.SteppingAllocations);
+
+		JsonCase->SetObjectField(TEXT("PhaseMs"), JsonPhases);
+		JsonCase->SetNumberField(TEXT("TotalMs"), Result.TotalMs);
+		JsonCase->SetNumberField(TEXT("ChainBytes"), static_cast<double>(Result.ChainBytes));
+		JsonCase->SetNumberField(TEXT("SteppingAllocations"), static_cast<double>(Result.SteppingAllocations));
+
+		JsonCases.Add(MakeShared<FJsonValueObject>(JsonCase));
+	}
+
+	TSharedRef<FJsonObject> JsonRoot = MakeShared<FJsonObject>();
+	JsonRoot->SetArrayField(TEXT("Cases"), JsonCases);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(JsonRoot, JsonWriter);
+
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(OutputPath));
+
+	const FString CsvPath = OutputPath + TEXT(".csv");
+	const FString JsonPath = OutputPath + TEXT(".json");
+
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath) && FFileHelper::SaveStringToFile(Json, *JsonPath))
+	{
+		UE_LOG(ChainBenchmarkLog, Display, TEXT("Wrote %s and %s"), *CsvPath, *JsonPath);
+	}
+	else
+	{
+		UE_LOG(ChainBenchmarkLog, Error, TEXT("Failed to write the reports to %s"), *OutputPath);
+	}
+}
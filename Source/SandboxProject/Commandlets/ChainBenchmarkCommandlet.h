@@ -0,0 +1,101 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ChainBenchmarkCommandlet.generated.h"
+
+class UChainComponent;
+class UStaticMesh;
+
+/**
+ * Steps populations of chains in an empty world and reports the time spent in every phase of a step.
+ *
+ * Usage:
+ *  UnrealEditor-Cmd SandboxProject -run=ChainBenchmark -nullrhi [options]
+ *
+ * Options:
+ *  -Chains=64            Chains per case.
+ *  -Segments=16,64,256   Segment counts, one case each.
+ *  -Stiffness=4          Solver iterations of every chain.
+ *  -Frames=600           Measured frames per case.
+ *  -Warmup=60            Frames stepped before measuring.
+ *  -Backend=Scalar       Solver backend, any EChainSolverBackend name.
+ *  -Spline               Spawns USplineChainComponent instead of UChainComponent.
+ *  -Collision            Sweeps the chain points against a floor.
+ *  -SelfCollision        Enables self collision.
+ *  -Cable                Uses the cable render mode instead of instances.
+ *  -Output=<path>        Report path without extension, defaults to Saved/Benchmarks/ChainBenchmark-<time>.
+ *
+ * Writes <Output>.csv and <Output>.json with one row per case. Phase timings are in milliseconds per frame
+ * summed over all chains, chains are stepped serially on the game thread so phases do not overlap. The allocation
+ * column counts every allocation the game thread makes during the measured frames.
+ */
+UCLASS()
+class SANDBOXPROJECT_API UChainBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UChainBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * Parameters of one benchmark case.
+	 */
+	struct FCase
+	{
+		int32 NumChains = 64;
+		int32 Segments = 64;
+		int32 Stiffness = 4;
+		int32 Frames = 600;
+		int32 WarmupFrames = 60;
+		int64 Backend = 0;
+		bool bSpline = false;
+		bool bCollision = false;
+		bool bSelfCollision = false;
+		bool bCable = false;
+	};
+
+	/**
+	 * Measurements of one benchmark case.
+	 */
+	struct FResult
+	{
+		FCase Case;
+
+		/** Milliseconds per frame of each phase, summed over the chains. */
+		TArray<double> PhaseMs;
+
+		/** Milliseconds per frame of the whole step. */
+		double TotalMs = 0.0;
+
+		/** Memory of the chain buffers, summed over the chains. */
+		SIZE_T ChainBytes = 0;
+
+		/** Allocations made on the game thread during the measured frames. */
+		uint64 SteppingAllocations = 0;
+	};
+
+	/**
+	 * Creates the chains of a case in a new world, steps them and destroys the world.
+	 */
+	FResult RunCase(const FCase& Case);
+
+	/**
+	 * Creates the component of one chain on a new actor.
+	 */
+	UChainComponent* SpawnChain(UWorld* World, const FCase& Case, const FVector& Location);
+
+	/**
+	 * Writes the results as CSV and JSON next to each other.
+	 */
+	void WriteReports(const TArray<FResult>& Results, const FString& OutputPath) const;
+
+	/** Mesh of the chain links and the collision floor. */
+	UPROPERTY()
+	UStaticMesh* BenchmarkMesh;
+};
@@ -0,0 +1,114 @@
+// This is Sandbox Project.
+
+#include "ChainAttachment.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMeshSocket.h"
+
+namespace ChainAttachment
+{
+	/** Frames between two attempts to resolve a reference whose component is missing. */
+	constexpr uint64 RetryInterval = 30;
+}
+
+void FChainAttachment::Resolve(const FComponentReference& Reference, FName Socket, AActor* Owner)
+{
+	bDirty = false;
+	Component = nullptr;
+	SocketAsset = nullptr;
+	ReferencedActor = Reference.OtherActor.Get();
+	ReferencedProperty = Reference.ComponentProperty;
+	SocketName = Socket;
+	SocketTransform = FTransform::Identity;
+	BoneIndex = INDEX_NONE;
+	SocketSource = ESocketSource::None;
+
+	// Chains treat a reference without an actor as no attachment at all.
+	bReferenced = ReferencedActor.IsValid();
+	if (! bReferenced) return;
+
+	USceneComponent* ResolvedComponent = Cast<USceneComponent>(Reference.GetComponent(Owner));
+
+	if (! ResolvedComponent)
+	{
+		RetryFrame = GFrameCounter + ChainAttachment::RetryInterval;
+		return;
+	}
+
+	Component = ResolvedComponent;
+	if (Socket == NAME_None) return;
+
+	SocketAsset = GetSocketAsset(ResolvedComponent);
+	SocketSource = ESocketSource::Named;
+
+	if (const USkinnedMeshComponent* SkinnedMesh = Cast<USkinnedMeshComponent>(ResolvedComponent))
+	{
+		BoneIndex = SkinnedMesh->GetBoneIndex(Socket);
+
+		if (BoneIndex == INDEX_NONE)
+		{
+			SkinnedMesh->GetSocketInfoByName(Socket, SocketTransform, BoneIndex);
+		}
+
+		if (BoneIndex != INDEX_NONE)
+		{
+			SocketSource = ESocketSource::Bone;
+		}
+	}
+	else if (const UStaticMeshComponent* StaticMesh = Cast<UStaticMeshComponent>(ResolvedComponent))
+	{
+		if (const UStaticMeshSocket* MeshSocket = StaticMesh->GetSocketByName(Socket))
+		{
+			SocketTransform = FTransform(MeshSocket->RelativeRotation, MeshSocket->RelativeLocation, MeshSocket->RelativeScale);
+			SocketSource = ESocketSource::Mesh;
+		}
+	}
+}
+
+bool FChainAttachment::NeedsResolve(const FComponentReference& Reference, FName Socket) const
+{
+	if (bDirty || Socket != SocketName || Reference.ComponentProperty != ReferencedProperty || Reference.OtherActor.Get() != ReferencedActor.Get()) return true;
+	if (! bReferenced) return false;
+
+	const USceneComponent* ResolvedComponent = Component.Get();
+	if (! ResolvedComponent) return GFrameCounter >= RetryFrame;
+
+	// Swapping the mesh invalidates bone indices and socket transforms.
+	return SocketName != NAME_None && GetSocketAsset(ResolvedComponent) != SocketAsset.Get();
+}
+
+FVector FChainAttachment::GetSocketLocation() const
+{
+	const USceneComponent* ResolvedComponent = Component.Get();
+	if (! ResolvedComponent) return FVector::ZeroVector;
+
+	switch (SocketSource)
+	{
+		case ESocketSource::Bone:
+			return static_cast<const USkinnedMeshComponent*>(ResolvedComponent)->GetBoneTransform(BoneIndex).TransformPosition(SocketTransform.GetLocation());
+
+		case ESocketSource::Mesh:
+			return ResolvedComponent->GetComponentTransform().TransformPosition(SocketTransform.GetLocation());
+
+		case ESocketSource::Named:
+			return ResolvedComponent->GetSocketLocation(SocketName);
+
+		default:
+			return ResolvedComponent->GetComponentLocation();
+	}
+}
+
+const UObject* FChainAttachment::GetSocketAsset(const USceneComponent* InComponent)
+{
+	if (const USkinnedMeshComponent* SkinnedMesh = Cast<USkinnedMeshComponent>(InComponent))
+	{
+		return SkinnedMesh->GetSkinnedAsset();
+	}
+
+	if (const UStaticMeshComponent* StaticMesh = Cast<UStaticMeshComponent>(InComponent))
+	{
+		return StaticMesh->GetStaticMesh();
+	}
+
+	return nullptr;
+}
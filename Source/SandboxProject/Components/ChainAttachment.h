@@ -0,0 +1,115 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+class USceneComponent;
+
+/**
+ * Resolved target of a chain FComponentReference.
+ *
+ * Resolving a component reference walks the component list of the actor by name, and socket lookups
+ * search the mesh sockets by name. Both are done once and cached here: the component as a weak pointer,
+ * the socket as a bone index or a mesh relative transform. The cache resolves again when the reference
+ * is changed, the component is destroyed or recreated, or the mesh of the component is swapped.
+ */
+struct SANDBOXPROJECT_API FChainAttachment
+{
+	/**
+	 * Resolves the referenced component and its socket.
+	 *
+	 * @param Reference The component reference to resolve.
+	 * @param Socket The socket on the referenced component, NAME_None for the component origin.
+	 * @param Owner The actor the reference is relative to if it does not name another actor.
+	 */
+	void Resolve(const FComponentReference& Reference, FName Socket, AActor* Owner);
+
+	/**
+	 * Cheap check run before every use, compares the reference with the cached one without any name lookup.
+	 * A reference whose component could not be found is only retried every few frames.
+	 *
+	 * @return True if Resolve has to run before the cache is used.
+	 */
+	bool NeedsResolve(const FComponentReference& Reference, FName Socket) const;
+
+	/**
+	 * Forces a resolve on the next use.
+	 */
+	FORCEINLINE void Invalidate() { bDirty = true; }
+
+	/**
+	 * @return True if the reference names an actor, the chain point is attached to it even if the component is missing.
+	 */
+	FORCEINLINE bool IsReferenced() const { return bReferenced; }
+
+	/**
+	 * @return True if a socket was requested and found.
+	 */
+	FORCEINLINE bool HasSocket() const { return SocketSource != ESocketSource::None; }
+
+	/**
+	 * @return The resolved component, or null if it could not be found or was destroyed.
+	 */
+	FORCEINLINE USceneComponent* GetComponent() const { return Component.Get(); }
+
+	/**
+	 * @return The world location of the resolved socket, or of the component if there is no socket.
+	 */
+	FVector GetSocketLocation() const;
+
+private:
+	/**
+	 * @return The mesh the sockets of the component belong to, if any.
+	 */
+	static const UObject* GetSocketAsset(const USceneComponent* InComponent);
+
+	/** Where the socket transform comes from. */
+	enum class ESocketSource : uint8
+	{
+		/** No socket, the component origin is used. */
+		None,
+
+		/** A bone of a skinned mesh, with SocketTransform relative to the bone. */
+		Bone,
+
+		/** A static mesh socket, with SocketTransform relative to the component. */
+		Mesh,
+
+		/** Any other socket, looked up by name on every use. */
+		Named,
+	};
+
+	/** The resolved component. */
+	TWeakObjectPtr<USceneComponent> Component;
+
+	/** The mesh the socket was resolved against. */
+	TWeakObjectPtr<const UObject> SocketAsset;
+
+	/** Actor of the reference at the time of the resolve. */
+	TWeakObjectPtr<AActor> ReferencedActor;
+
+	/** Component name of the reference at the time of the resolve. */
+	FName ReferencedProperty;
+
+	/** The requested socket. */
+	FName SocketName;
+
+	/** Socket transform relative to the bone or the component. */
+	FTransform SocketTransform = FTransform::Identity;
+
+	/** The bone of the socket for ESocketSource::Bone. */
+	int32 BoneIndex = INDEX_NONE;
+
+	/** Frame from which a failed resolve is retried. */
+	uint64 RetryFrame = 0;
+
+	ESocketSource SocketSource = ESocketSource::None;
+
+	/** Whether the reference names an actor. */
+	bool bReferenced = false;
+
+	/** Whether the cache was never resolved or invalidated. */
+	bool bDirty = true;
+};
@@ -4,427 +4,2169 @@
 #include "DrawDebugHelpers.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "EngineGlobals.h"
+#include "SandboxProject/Subsystems/ChainSimulationSubsystem.h"
+#include "ChainStats.h"
+#include "SignificanceManager.h"
+#include "Algo/BinarySearch.h"
+#include "ChainSceneProxy.h"
+#include "Engine/StaticMesh.h"
+#include "RenderingThread.h"
+#include "Net/UnrealNetwork.h"
+#include "Misc/App.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+
+namespace ChainLOD
+{
+	/** Tag of the chains in the significance manager. */
+	static const FName SignificanceTag(TEXT("Chain"));
+}
+
+namespace ChainSleep
+{
+	/** Speed in cm/s above which an object found by the wake probe wakes the chain up. */
+	constexpr float WakeProbeSpeed = 1.0f;
+}
+
+namespace ChainSubstep
+{
+	/** Substep rate the Gravity property is tuned for. */
+	constexpr float ReferenceRate = 60.0f;
+}
+
+UChainComponent::UChainComponent(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	bTickInEditor = true;
+	bAutoActivate = true;
+	InstanceComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("InstanceComponent"));
+	InstanceComponent->InstancingRandomSeed = FMath::Rand();
+
+	LODSettings.Emplace(1500.0f, 1, -1, true, 1);
+	LODSettings.Emplace(4000.0f, 2, 4, true, 1);
+	LODSettings.Emplace(10000.0f, 4, 2, false, 2);
+}
+
+void UChainComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	// Components of the owner may have been recreated since the last registration.
+	InvalidateAttachments();
+	InitChain();
+
+	// Pooled chains stay out of the simulation until they are acquired.
+	if (bPooled)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	if (UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem())
+	{
+		Subsystem->RegisterChain(this);
+		bRegisteredWithSubsystem = true;
+		SetComponentTickEnabled(false);
+	}
+
+	// Area queries reach every chain of the world, including the ones ticking on their own.
+	if (UChainSimulationSubsystem* QuerySubsystem = UWorld::GetSubsystem<UChainSimulationSubsystem>(GetWorld()))
+	{
+		QuerySubsystem->AddQueryChain(this);
+	}
+
+	RegisterSignificance();
+}
+
+void UChainComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+	Super::RegisterComponentTickFunctions(bRegister);
+
+	// The subsystem steps batched chains, a component tick would step them a second time. Pooled chains do not step at all.
+	if (bRegister && (bRegisteredWithSubsystem || bPooled))
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UChainComponent::OnUnregister()
+{
+	Super::OnUnregister();
+
+	if (UChainSimulationSubsystem* Subsystem = UWorld::GetSubsystem<UChainSimulationSubsystem>(GetWorld()))
+	{
+		if (bRegisteredWithSubsystem)
+		{
+			Subsystem->UnregisterChain(this);
+		}
+
+		Subsystem->RemoveQueryChain(this);
+	}
+	bRegisteredWithSubsystem = false;
+
+	UnregisterSignificance();
+
+	InstanceComponent->ClearInstances();
+	ResizeChainBuffers(0);
+}
+
+void UChainComponent::SetChainPooled(bool bInPooled)
+{
+	if (bPooled == bInPooled) return;
+	bPooled = bInPooled;
+
+	SetVisibility(! bPooled, true);
+
+	if (! IsRegistered()) return;
+
+	if (bPooled)
+	{
+		if (UChainSimulationSubsystem* Subsystem = UWorld::GetSubsystem<UChainSimulationSubsystem>(GetWorld()))
+		{
+			if (bRegisteredWithSubsystem)
+			{
+				Subsystem->UnregisterChain(this);
+			}
+
+			Subsystem->RemoveQueryChain(this);
+		}
+		bRegisteredWithSubsystem = false;
+
+		UnregisterSignificance();
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	if (UChainSimulationSubsystem* Subsystem = GetSimulationSubsystem())
+	{
+		Subsystem->RegisterChain(this);
+		bRegisteredWithSubsystem = true;
+	}
+	else
+	{
+		SetComponentTickEnabled(true);
+	}
+
+	if (UChainSimulationSubsystem* QuerySubsystem = UWorld::GetSubsystem<UChainSimulationSubsystem>(GetWorld()))
+	{
+		QuerySubsystem->AddQueryChain(this);
+	}
+
+	RegisterSignificance();
+}
+
+void UChainComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	if (bRegisteredWithSubsystem || bPooled) return;
+
+	StepChain(DeltaTime);
+	DrawChainPoints();
+}
+
+bool UChainComponent::StepChain(float DeltaTime)
+{
+	const bool bStepped = PreSimulate(DeltaTime);
+
+	if (bStepped)
+	{
+		Simulate();
+		PostSimulate();
+	}
+	else if (HasPendingEvents())
+	{
+		// Events held back by their interval are sent once it elapsed, even if the chain does not step anymore.
+		DispatchEvents();
+	}
+
+	UpdateRender();
+
+	return bStepped;
+}
+
+void UChainComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Only takes effect on the server, clients receive the replicated flag with the actor.
+	if (bReplicateChain)
+	{
+		SetIsReplicated(true);
+	}
+
+	// OnRegister already initialized the chain, only chains that were changed since need another InitChain.
+	if (HasBegunPlay() && GetNumChainPoints() != Segments)
+	{
+		InitChain();
+	}
+}
+
+TArray<int> UChainComponent::ApplyForce(FVector InPosition, float InRadius, FVector InForce)
+{
+	TArray<int> AffectedPoints;
+	ApplyForce(InPosition, InRadius, InForce, AffectedPoints);
+
+	return AffectedPoints;
+}
+
+int32 UChainComponent::ApplyForce(const FVector& InPosition, float InRadius, const FVector& InForce, TArray<int32>& OutAffectedPoints)
+{
+	OutAffectedPoints.Reset();
+
+	if (! OverlapsSphere(InPosition, InRadius)) return 0;
+
+	const double RadiusSquared = FMath::Square(InRadius);
+	const int32 NumPoints = Positions.Num();
+
+	// A segment crossing the sphere affects both of its points, even if they lie outside of the radius.
+	// A point inside the sphere always has a segment crossing it, so only single point chains test the point itself.
+	bool bPreviousSegmentHit = NumPoints == 1 && FVector::DistSquared(InPosition, Positions[0]) <= RadiusSquared;
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const bool bNextSegmentHit = i + 1 < NumPoints && FMath::PointDistToSegmentSquared(InPosition, Positions[i], Positions[i + 1]) <= RadiusSquared;
+
+		if (bPreviousSegmentHit || bNextSegmentHit)
+		{
+			OutAffectedPoints.Add(i);
+			Forces[i] -= InForce;
+		}
+
+		bPreviousSegmentHit = bNextSegmentHit;
+	}
+
+	if (OutAffectedPoints.Num() > 0)
+	{
+		WakeChain();
+	}
+
+	return OutAffectedPoints.Num();
+}
+
+bool UChainComponent::OverlapsSphere(const FVector& Center, float Radius) const
+{
+	if (Positions.Num() == 0) return false;
+
+	return GetChainBounds().ComputeSquaredDistanceToPoint(Center) <= FMath::Square(Radius);
+}
+
+FVector UChainComponent::GetChainPoint(int index)
+{
+	return Positions.IsValidIndex(index) ? Positions[index] : FVector::ZeroVector;
+}
+
+TArray<FChainPointData> UChainComponent::GetChainPoints() const
+{
+	TArray<FChainPointData> ChainPoints;
+	ChainPoints.Reserve(Positions.Num());
+
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		ChainPoints.Add(MakeChainPointData(i));
+	}
+
+	return ChainPoints;
+}
+
+void UChainComponent::UpdateQueryCache() const
+{
+	if (! bQueryCacheDirty) return;
+	bQueryCacheDirty = false;
+
+	const int32 NumPoints = Positions.Num();
+	CumulativeLengths.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+	CachedBounds = FBox(ForceInit);
+
+	float Length = 0.0f;
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		// The gap of a broken link is not part of the chain length.
+		Length += i > 0 && ! BrokenLinks[i - 1] ? FVector::Dist(Positions[i - 1], Positions[i]) : 0.0f;
+		CumulativeLengths[i] = Length;
+		CachedBounds += Positions[i];
+	}
+}
+
+FVector UChainComponent::GetPointAtNormalizedDistance(float NormalizedDistance) const
+{
+	if (Positions.Num() < 2) return Positions.Num() > 0 ? Positions[0] : GetComponentLocation();
+
+	UpdateQueryCache();
+
+	const float Distance = FMath::Clamp(NormalizedDistance, 0.0f, 1.0f) * CumulativeLengths.Last();
+	const int32 Next = FMath::Clamp(Algo::UpperBound(CumulativeLengths, Distance), 1, Positions.Num() - 1);
+	const float SegmentStart = CumulativeLengths[Next - 1];
+	const float SegmentSize = CumulativeLengths[Next] - SegmentStart;
+	const float Alpha = SegmentSize > UE_KINDA_SMALL_NUMBER ? (Distance - SegmentStart) / SegmentSize : 0.0f;
+
+	return FMath::Lerp(Positions[Next - 1], Positions[Next], Alpha);
+}
+
+FVector UChainComponent::FindNearestPoint(FVector Location, int32& SegmentIndex, float& NormalizedDistance) const
+{
+	SegmentIndex = INDEX_NONE;
+	NormalizedDistance = 0.0f;
+
+	if (Positions.Num() < 2) return Positions.Num() > 0 ? Positions[0] : GetComponentLocation();
+
+	UpdateQueryCache();
+
+	FVector Nearest = Positions[0];
+	double NearestDistanceSquared = TNumericLimits<double>::Max();
+
+	for (int32 i = 0; i < Positions.Num() - 1; i++)
+	{
+		if (BrokenLinks[i]) continue;
+
+		const FVector Candidate = FMath::ClosestPointOnSegment(Location, Positions[i], Positions[i + 1]);
+		const double DistanceSquared = FVector::DistSquared(Location, Candidate);
+
+		if (DistanceSquared < NearestDistanceSquared)
+		{
+			NearestDistanceSquared = DistanceSquared;
+			Nearest = Candidate;
+			SegmentIndex = i;
+		}
+	}
+
+	// Every link of the chain is broken.
+	if (SegmentIndex == INDEX_NONE) return Nearest;
+
+	const float Length = CumulativeLengths.Last();
+	NormalizedDistance = Length > UE_KINDA_SMALL_NUMBER ? (CumulativeLengths[SegmentIndex] + FVector::Dist(Positions[SegmentIndex], Nearest)) / Length : 0.0f;
+
+	return Nearest;
+}
+
+FBox UChainComponent::GetChainBounds() const
+{
+	UpdateQueryCache();
+
+	return CachedBounds;
+}
+
+float UChainComponent::GetCurrentChainLength() const
+{
+	UpdateQueryCache();
+
+	return CumulativeLengths.Num() > 0 ? CumulativeLengths.Last() : 0.0f;
+}
+
+FChainPointData UChainComponent::MakeChainPointData(int32 PointIndex) const
+{
+	FChainPointData ChainPoint;
+	if (! Positions.IsValidIndex(PointIndex)) return ChainPoint;
+
+	ChainPoint.bFree = FreeFlags[PointIndex];
+	ChainPoint.Position = Positions[PointIndex];
+	ChainPoint.OldPosition = OldPositions[PointIndex];
+	ChainPoint.Velocity = Velocities[PointIndex];
+	ChainPoint.Force = Forces[PointIndex];
+	ChainPoint.Rotation = Rotations[PointIndex];
+	ChainPoint.Transform = FTransform(Rotations[PointIndex], Positions[PointIndex], Scale);
+	ChainPoint.Time = PointTimes[PointIndex];
+	ChainPoint.Index = PointIndex;
+	ChainPoint.Direction = Directions[PointIndex];
+
+	return ChainPoint;
+}
+
+void UChainComponent::AttachStartToActor(FComponentReference ComponentReference, FName Socket)
+{
+	AttachStartTo = ComponentReference;
+	AttachStartToSocket = Socket;
+	AttachStart = true;
+	AttachStartCache.Invalidate();
+	WakeChain();
+}
+
+void UChainComponent::AttachEndToActor(FComponentReference ComponentReference, FName Socket)
+{
+	AttachEndTo = ComponentReference;
+	AttachEndToSocket = Socket;
+	AttachEnd = true;
+	AttachEndCache.Invalidate();
+	WakeChain();
+}
+
+#if WITH_EDITOR
+void UChainComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Editing a component reference may only change its path, which the cheap check does not compare.
+	InvalidateAttachments();
+
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(UChainComponent, RenderMode))
+	{
+		InitChain();
+		MarkRenderStateDirty();
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(UChainComponent, CableRadius) || PropertyName == GET_MEMBER_NAME_CHECKED(UChainComponent, CableSides) || PropertyName == GET_MEMBER_NAME_CHECKED(UChainComponent, CableTextureLength))
+	{
+		MarkRenderStateDirty();
+	}
+}
+#endif
+
+void UChainComponent::WakeChain()
+{
+	bSleeping = false;
+	RestingSteps = 0;
+}
+
+void UChainComponent::RegisterSignificance()
+{
+	if (! bUseSignificance || bRegisteredWithSignificance) return;
+
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (! SignificanceManager) return;
+
+	// Both callbacks run inside USignificanceManager::Update, the significance function possibly on worker threads.
+	auto SignificanceFunction = [this](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+	{
+		return CalculateSignificance(Viewpoint);
+	};
+
+	auto PostSignificanceFunction = [this](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+	{
+		SetSignificance(Significance);
+	};
+
+	SignificanceManager->RegisterObject(this, ChainLOD::SignificanceTag, SignificanceFunction, USignificanceManager::EPostSignificanceType::Sequential, PostSignificanceFunction);
+	bRegisteredWithSignificance = true;
+}
+
+void UChainComponent::UnregisterSignificance()
+{
+	if (! bRegisteredWithSignificance) return;
+
+	if (USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterObject(this);
+	}
+
+	bRegisteredWithSignificance = false;
+	CurrentLOD = 0;
+}
+
+float UChainComponent::CalculateSignificance(const FTransform& Viewpoint) const
+{
+	if (! WasChainRecentlyRendered()) return 0.0f;
+
+	const FVector Center = Positions.Num() > 0 ? Positions[Positions.Num() / 2] : GetComponentLocation();
+
+	return static_cast<float>(LODSettings.Num() - GetLODForDistance(FVector::DistSquared(Viewpoint.GetLocation(), Center)));
+}
+
+int32 UChainComponent::GetLODForDistance(double DistanceSquared) const
+{
+	for (int32 i = 0; i < LODSettings.Num(); i++)
+	{
+		if (DistanceSquared <= FMath::Square(LODSettings[i].MaxDistance))
+		{
+			return i;
+		}
+	}
+
+	return FMath::Max(LODSettings.Num() - 1, 0);
+}
+
+void UChainComponent::UpdateNetLOD()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastNetLODTime < ReplicationInterval) return;
+	LastNetLODTime = Now;
+
+	NetLOD = INDEX_NONE;
+
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const AActor* Owner = GetOwner();
+	if (! NetDriver || ! Owner || Positions.Num() == 0) return;
+
+	const FVector Center = Positions[Positions.Num() / 2];
+	double ClosestDistanceSquared = UE_BIG_NUMBER;
+
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (! Connection || ! Connection->ViewTarget) continue;
+
+		const FVector ViewLocation = Connection->ViewTarget->GetActorLocation();
+
+		if (Owner->IsNetRelevantFor(Connection->PlayerController, Connection->ViewTarget, ViewLocation))
+		{
+			ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, FVector::DistSquared(ViewLocation, Center));
+		}
+	}
+
+	if (ClosestDistanceSquared < UE_BIG_NUMBER)
+	{
+		NetLOD = GetLODForDistance(ClosestDistanceSquared);
+	}
+}
+
+bool UChainComponent::WasChainRecentlyRendered() const
+{
+	// Without a renderer nothing is ever rendered, every chain would be considered offscreen.
+	if (! FApp::CanEverRender()) return true;
+
+	// Cables are drawn by the proxy of the chain component, the instanced mesh has no instances then.
+	if (RenderMode == EChainRenderMode::Cable) return WasRecentlyRendered(OffscreenDelay);
+
+	return InstanceComponent->WasRecentlyRendered(OffscreenDelay);
+}
+
+void UChainComponent::SetSignificance(float Significance)
+{
+	CurrentLOD = Significance > 0.0f ? FMath::Max(LODSettings.Num() - FMath::RoundToInt32(Significance), 0) : INDEX_NONE;
+}
+
+const FChainLODSettings& UChainComponent::GetActiveLODSettings() const
+{
+	static const FChainLODSettings FullDetail;
+
+	// Remote viewers keep the chain at their level of detail, lower indices are more detailed.
+	const int32 LOD = NetLOD != INDEX_NONE && (CurrentLOD == INDEX_NONE || NetLOD < CurrentLOD) ? NetLOD : CurrentLOD;
+
+	if (LOD == INDEX_NONE) return OffscreenLODSettings;
+
+	return LODSettings.IsValidIndex(LOD) ? LODSettings[LOD] : FullDetail;
+}
+
+int32 UChainComponent::GetSolverIterations() const
+{
+	const int32 MaxIterations = GetActiveLODSettings().MaxIterations;
+
+	return MaxIterations < 0 ? Stiffness : FMath::Min(Stiffness, MaxIterations);
+}
+
+int32 UChainComponent::GetStepInterval() const
+{
+	return (Skip + 1) * GetActiveLODSettings().TickInterval;
+}
+
+void UChainComponent::RebuildSimulatedIndices(int32 Stride)
+{
+	const int32 NumPoints = Positions.Num();
+	SimulatedStride = FMath::Max(Stride, 1);
+	SimulatedIndices.Reset();
+	BrokenConstraints.Reset();
+
+	if (BrokenLinkIndices.Num() > 0)
+	{
+		for (int32 i = 0; i < NumPoints; i++)
+		{
+			// Both points of a broken link are simulated, so no skipped point is interpolated across the break.
+			const bool bBrokenBefore = i > 0 && BrokenLinks[i - 1];
+
+			if (i % SimulatedStride == 0 || i == NumPoints - 1 || BrokenLinks[i] || bBrokenBefore)
+			{
+				if (i > 0)
+				{
+					BrokenConstraints.Add(bBrokenBefore);
+				}
+
+				SimulatedIndices.Add(i);
+			}
+		}
+
+		return;
+	}
+
+	for (int32 i = 0; i < NumPoints; i += SimulatedStride)
+	{
+		SimulatedIndices.Add(i);
+	}
+
+	if (NumPoints > 0 && SimulatedIndices.Last() != NumPoints - 1)
+	{
+		SimulatedIndices.Add(NumPoints - 1);
+	}
+}
+
+void UChainComponent::InterpolateSkippedPoints()
+{
+	for (int32 k = 0; k < SimulatedIndices.Num() - 1; k++)
+	{
+		const int32 A = SimulatedIndices[k];
+		const int32 B = SimulatedIndices[k + 1];
+
+		for (int32 i = A + 1; i < B; i++)
+		{
+			if (! FreeFlags[i]) continue;
+
+			const float Alpha = static_cast<float>(i - A) / static_cast<float>(B - A);
+			Positions[i] = FMath::Lerp(Positions[A], Positions[B], Alpha);
+			OldPositions[i] = FMath::Lerp(OldPositions[A], OldPositions[B], Alpha);
+			Velocities[i] = FMath::Lerp(Velocities[A], Velocities[B], Alpha);
+
+			if (! Forces[i].IsNearlyZero())
+			{
+				Forces[Alpha < 0.5f ? A : B] += Forces[i];
+				Forces[i] = FVector::ZeroVector;
+			}
+		}
+	}
+}
+
+void UChainComponent::DetectBreaks()
+{
+	// Clients break the links the server reports, see OnRep_BrokenLinks.
+	if (BreakStretch <= 0.0f || IsReplicationClient()) return;
+
+	float Stretch = 0.0f;
+	const int32 Constraint = ChainSolver::FindMostStretched(Positions, SimulatedIndices, SegmentLength, BrokenConstraints, Stretch);
+
+	if (Constraint != INDEX_NONE && Stretch > BreakStretch)
+	{
+		MarkLinkBroken(SimulatedIndices[Constraint]);
+	}
+}
+
+void UChainComponent::MarkLinkBroken(int32 LinkIndex)
+{
+	check(BrokenLinks.IsValidIndex(LinkIndex) && LinkIndex < Positions.Num() - 1);
+
+	// A link broken twice would be listed twice and send a second event.
+	if (BrokenLinks[LinkIndex]) return;
+
+	BrokenLinks[LinkIndex] = true;
+	BrokenLinkIndices.Insert(LinkIndex, Algo::LowerBound(BrokenLinkIndices, LinkIndex));
+	PendingBrokenLinks.Add(LinkIndex);
+
+	// The pieces share the point buffers, only the simulated indices change.
+	RebuildSimulatedIndices(SimulatedStride);
+	InvalidateQueryCache();
+	bRenderDirty = true;
+}
+
+bool UChainComponent::BreakLink(int32 LinkIndex)
+{
+	if (! BrokenLinks.IsValidIndex(LinkIndex) || LinkIndex >= Positions.Num() - 1 || BrokenLinks[LinkIndex]) return false;
+
+	MarkLinkBroken(LinkIndex);
+	WakeChain();
+
+	return true;
+}
+
+bool UChainComponent::IsLinkBroken(int32 LinkIndex) const
+{
+	return BrokenLinks.IsValidIndex(LinkIndex) && BrokenLinks[LinkIndex];
+}
+
+void UChainComponent::GetChainPiece(int32 PieceIndex, int32& FirstPoint, int32& LastPoint) const
+{
+	FirstPoint = INDEX_NONE;
+	LastPoint = INDEX_NONE;
+
+	if (PieceIndex < 0 || PieceIndex > BrokenLinkIndices.Num() || Positions.Num() == 0) return;
+
+	FirstPoint = PieceIndex > 0 ? BrokenLinkIndices[PieceIndex - 1] + 1 : 0;
+	LastPoint = PieceIndex < BrokenLinkIndices.Num() ? BrokenLinkIndices[PieceIndex] : Positions.Num() - 1;
+}
+
+bool UChainComponent::IsReplicationAuthority() const
+{
+	return bReplicateChain && GetIsReplicated() && GetOwnerRole() == ROLE_Authority && GetNetMode() != NM_Standalone;
+}
+
+bool UChainComponent::IsReplicationClient() const
+{
+	return bReplicateChain && GetNetMode() == NM_Client;
+}
+
+void UChainComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UChainComponent, ReplicatedKeyframes);
+	DOREPLIFETIME(UChainComponent, ReplicatedBrokenLinks);
+}
+
+void UChainComponent::UpdateReplicatedKeyframes(bool bForce)
+{
+	const int32 NumPoints = FMath::Min(Positions.Num(), static_cast<int32>(MAX_uint16) + 1);
+	if (NumPoints == 0) return;
+
+	if (ReplicatedBrokenLinks != BrokenLinkIndices)
+	{
+		ReplicatedBrokenLinks = BrokenLinkIndices;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const int32 LODScale = NetLOD == INDEX_NONE ? LODSettings.Num() : NetLOD + 1;
+
+	if (! bForce && Now - LastReplicationTime < ReplicationInterval * FMath::Max(LODScale, 1)) return;
+	LastReplicationTime = Now;
+
+	const int32 Stride = FMath::Max(ReplicationKeyframeStride, 1);
+	const int32 NumKeyframes = FMath::DivideAndRoundUp(NumPoints - 1, Stride) + 1;
+	TArray<FChainKeyframe>& Keyframes = ReplicatedKeyframes.Items;
+
+	// A new layout is sent in full once, later updates only carry the diverged keyframes.
+	if (Keyframes.Num() != NumKeyframes)
+	{
+		Keyframes.Reset(NumKeyframes);
+
+		for (int32 k = 0; k < NumKeyframes; k++)
+		{
+			FChainKeyframe& Keyframe = Keyframes.AddDefaulted_GetRef();
+			Keyframe.PointIndex = static_cast<uint16>(FMath::Min(k * Stride, NumPoints - 1));
+			Keyframe.Location = Positions[Keyframe.PointIndex];
+			ReplicatedKeyframes.MarkItemDirty(Keyframe);
+		}
+
+		ReplicatedKeyframes.MarkArrayDirty();
+		INC_DWORD_STAT_BY(STAT_ChainReplicatedKeyframes, NumKeyframes);
+		return;
+	}
+
+	const double ToleranceSquared = FMath::Square(ReplicationTolerance);
+	KeyframeErrors.Reset();
+
+	for (int32 k = 0; k < NumKeyframes; k++)
+	{
+		const FChainKeyframe& Keyframe = Keyframes[k];
+
+		// Pinned points follow their attachments on the clients as well.
+		if (! FreeFlags[Keyframe.PointIndex]) continue;
+
+		const double ErrorSquared = FVector::DistSquared(Positions[Keyframe.PointIndex], Keyframe.Location);
+
+		if (ErrorSquared > ToleranceSquared)
+		{
+			KeyframeErrors.Emplace(ErrorSquared, k);
+		}
+	}
+
+	if (KeyframeErrors.Num() > ReplicationMaxKeyframes)
+	{
+		KeyframeErrors.Sort([](const TPair<double, int32>& A, const TPair<double, int32>& B) { return A.Key > B.Key; });
+	}
+
+	const int32 NumSent = FMath::Min(KeyframeErrors.Num(), ReplicationMaxKeyframes);
+
+	for (int32 k = 0; k < NumSent; k++)
+	{
+		FChainKeyframe& Keyframe = Keyframes[KeyframeErrors[k].Value];
+		Keyframe.Location = Positions[Keyframe.PointIndex];
+		ReplicatedKeyframes.MarkItemDirty(Keyframe);
+	}
+
+	INC_DWORD_STAT_BY(STAT_ChainReplicatedKeyframes, NumSent);
+}
+
+bool UChainComponent::ApplyReplicatedKeyframes()
+{
+	if (ReplicationBlend <= 0.0f) return false;
+
+	const double ToleranceSquared = FMath::Square(ReplicationTolerance);
+	bool bAnyPending = false;
+
+	for (FChainKeyframe& Keyframe : ReplicatedKeyframes.Items)
+	{
+		if (! Keyframe.bPending) continue;
+
+		const int32 i = Keyframe.PointIndex;
+		const FVector Error = Positions.IsValidIndex(i) && FreeFlags[i] ? Keyframe.Location - Positions[i] : FVector::ZeroVector;
+
+		if (Error.SizeSquared() <= ToleranceSquared)
+		{
+			Keyframe.bPending = false;
+			continue;
+		}
+
+		const FVector Correction = Error * ReplicationBlend;
+		Positions[i] += Correction;
+		OldPositions[i] += Correction;
+		bAnyPending = true;
+	}
+
+	return bAnyPending;
+}
+
+void UChainComponent::OnRep_BrokenLinks()
+{
+	for (const int32 LinkIndex : ReplicatedBrokenLinks)
+	{
+		BreakLink(LinkIndex);
+	}
+}
+
+void UChainComponent::InitChain()
+{
+	InstanceComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	ResizeChainBuffers(Segments);
+
+	ChainStart = GetComponentLocation();
+	ChainEnd = GetChainEndPoint();
+
+	const FVector LengthVector = ChainEnd - ChainStart;
+	InstanceComponent->SetStaticMesh(ChainMesh);
+
+	float SegmentTime = 1.0f / static_cast<float>(Segments);
+	SegmentLength = (LengthVector.Size() / static_cast<float>(Segments)) * ChainLength;
+
+	for (int i = 0; i < Segments; i++)
+	{
+		PointTimes[i] = i * SegmentTime;
+		Positions[i] = ChainStart + ((static_cast<float>(i) / static_cast<float>(Segments)) * LengthVector);
+		OldPositions[i] = Positions[i];
+	}
+
+	SyncChainInstances(Segments);
+	ResetSimulationState();
+	ApplyRestPose();
+}
+
+void UChainComponent::SyncChainInstances(int32 NumInstances)
+{
+	if (RenderMode != EChainRenderMode::Cable && InstanceComponent->GetInstanceCount() == NumInstances) return;
+
+	InstanceComponent->ClearInstances();
+	AddChainInstances(NumInstances);
+}
+
+void UChainComponent::AddChainInstances(int32 NumInstances)
+{
+	// Cables are drawn by the scene proxy of the chain component.
+	if (RenderMode == EChainRenderMode::Cable) return;
+
+	TArray<FTransform> InstanceTransforms;
+	InstanceTransforms.Init(FTransform(FRotator::ZeroRotator, FVector::ZeroVector, Scale), NumInstances);
+
+	InstanceComponent->AddInstances(InstanceTransforms, false);
+}
+
+bool UChainComponent::HasValidRestPose() const
+{
+	return bUseRestPose && RestPose.Num() == Positions.Num() && RestPose.Num() > 1 && RestPoseHash == GetRestPoseHash();
+}
+
+bool UChainComponent::ApplyRestPose()
+{
+	if (! HasValidRestPose()) return false;
+
+	FVector Span;
+	const FTransform Frame = CalculateRestPoseFrame(Span);
+
+	// The sag only matches pins at the same distance and height difference, e.g. not after the end attachment moved.
+	if (! Span.Equals(RestPoseSpan, SleepAttachmentTolerance)) return false;
+
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		Positions[i] = Frame.TransformPosition(RestPose[i]);
+	}
+
+	OldPositions = Positions;
+	PreviousPositions = Positions;
+	RenderPositions = Positions;
+	InvalidateQueryCache();
+	UpdateOrientations();
+
+	// The pose is at rest by construction, the chain only wakes once something disturbs it.
+	if (bAllowSleep)
+	{
+		bSleeping = true;
+		SleepBounds = FBox(Positions).ExpandBy(ChainWidth);
+	}
+
+	return true;
+}
+
+FTransform UChainComponent::CalculateRestPoseFrame(FVector& OutSpan)
+{
+	ChainEnd = GetChainEndPoint();
+
+	// Free ends keep the location InitChain laid them out at.
+	CalculateChainPoint(AttachStart, AttachStartTo, AttachStartCache, AttachStartToSocket, 0);
+	CalculateChainPoint(AttachEnd, AttachEndTo, AttachEndCache, AttachEndToSocket, Positions.Num() - 1, true);
+
+	const FVector Start = Positions[0];
+	const FVector Delta = Positions.Last() - Start;
+	const double Yaw = FVector(Delta.X, Delta.Y, 0.0).IsNearlyZero() ? 0.0 : FMath::RadiansToDegrees(FMath::Atan2(Delta.Y, Delta.X));
+
+	const FTransform Frame(FRotator(0.0, Yaw, 0.0), Start);
+	OutSpan = Frame.InverseTransformVectorNoScale(Delta);
+
+	return Frame;
+}
+
+uint32 UChainComponent::GetRestPoseHash() const
+{
+	uint32 Hash = GetTypeHash(Segments);
+	Hash = HashCombine(Hash, GetTypeHash(ChainLength));
+	Hash = HashCombine(Hash, GetTypeHash(EndPoint));
+	Hash = HashCombine(Hash, GetTypeHash(bIsLocal));
+	Hash = HashCombine(Hash, GetTypeHash(Gravity));
+	Hash = HashCombine(Hash, GetTypeHash(AttachStart));
+	Hash = HashCombine(Hash, GetTypeHash(AttachEnd));
+
+	// Everything the bake simulation reads, the settled shape changes with any of it.
+	Hash = HashCombine(Hash, GetTypeHash(Stiffness));
+	Hash = HashCombine(Hash, GetTypeHash(SolverBackend));
+	Hash = HashCombine(Hash, GetTypeHash(Compliance));
+	Hash = HashCombine(Hash, GetTypeHash(SolverTolerance));
+	Hash = HashCombine(Hash, GetTypeHash(BreakStretch));
+	Hash = HashCombine(Hash, GetTypeHash(SubstepRate));
+	Hash = HashCombine(Hash, GetTypeHash(MaxSubsteps));
+	Hash = HashCombine(Hash, GetTypeHash(RestPoseBakeDuration));
+	Hash = HashCombine(Hash, GetTypeHash(SleepEnergyThreshold));
+	Hash = HashCombine(Hash, GetTypeHash(SleepFrames));
+
+	// World collision settings, the geometry around the chain is not covered.
+	Hash = HashCombine(Hash, GetTypeHash(GetCollisionEnabled()));
+	Hash = HashCombine(Hash, GetTypeHash(GetCollisionObjectType()));
+	Hash = HashCombine(Hash, FCrc::MemCrc32(GetCollisionResponseToChannels().EnumArray, sizeof(FCollisionResponseContainer::EnumArray)));
+	Hash = HashCombine(Hash, GetTypeHash(Friction));
+	Hash = HashCombine(Hash, GetTypeHash(ChainWidth));
+	Hash = HashCombine(Hash, GetTypeHash(bSelfCollision));
+	Hash = HashCombine(Hash, GetTypeHash(SelfCollisionWidth));
+	Hash = HashCombine(Hash, GetTypeHash(SelfCollisionThreshold));
+
+	return Hash;
+}
+
+void UChainComponent::BakeRestPose()
+{
+	Modify();
+
+	// Start from the straight line the chain would settle from at runtime.
+	RestPose.Reset();
+	RestPoseHash = 0;
+	InitChain();
+
+	if (Positions.Num() < 2) return;
+
+	FVector Span;
+	const FTransform Frame = CalculateRestPoseFrame(Span);
+
+	const float StepTime = 1.0f / (SubstepRate > 0.0f ? SubstepRate : ChainSubstep::ReferenceRate);
+	const int32 MaxSteps = FMath::CeilToInt32(RestPoseBakeDuration / StepTime);
+
+	{
+		// Bake at full detail on every step, with sweeps that complete within the step.
+		TGuardValue<int32> LODGuard(CurrentLOD, LODSettings.Num());
+		TGuardValue<int> SkipGuard(Skip, 0);
+		TGuardValue<bool> AllowSleepGuard(bAllowSleep, true);
+		TGuardValue<EChainCollisionQueryMode> QueryModeGuard(CollisionQueryMode, EChainCollisionQueryMode::Synchronous);
+
+		for (int32 Step = 0; Step < MaxSteps && ! bSleeping; Step++)
+		{
+			if (PreSimulate(StepTime))
+			{
+				Simulate();
+				ResolveCollision();
+				UpdateSleepState();
+			}
+		}
+	}
+
+	RestPose.SetNumUninitialized(Positions.Num());
+
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		RestPose[i] = Frame.InverseTransformPosition(Positions[i]);
+	}
+
+	RestPoseSpan = Span;
+	RestPoseHash = GetRestPoseHash();
+	InitChain();
+}
+
+void UChainComponent::ClearRestPose()
+{
+	Modify();
+
+	RestPose.Reset();
+	RestPoseHash = 0;
+	InitChain();
+}
+
+void UChainComponent::ResetSimulationState()
+{
+	WakeChain();
+
+	UploadedTransforms.Reset();
+	PendingSweeps.Reset();
+	bAsyncSweepsDiscarded = false;
+	PendingImpulses.Reset();
+	PreviousPositions = Positions;
+	RenderPositions = Positions;
+	TimeAccumulator = 0.0f;
+	InvalidateQueryCache();
+
+	SimulationStep = 0;
+	LastSnapshotStep = INDEX_NONE;
+	Snapshots.Reset(SnapshotCapacity);
+
+	// A chain that starts asleep is not stepped, its instances are uploaded once here.
+	bRenderDirty = true;
+}
+
+void UChainComponent::CaptureSnapshot()
+{
+	if (SnapshotCapacity <= 0) return;
+
+	if (Snapshots.GetCapacity() != SnapshotCapacity)
+	{
+		Snapshots.Reset(SnapshotCapacity);
+	}
+
+	FChainSnapshot& Snapshot = Snapshots.Add();
+	Snapshot.Step = SimulationStep;
+	Snapshot.TimeAccumulator = TimeAccumulator;
+	Snapshot.Frame = Frame;
+	Snapshot.RestingSteps = RestingSteps;
+	Snapshot.bSleeping = bSleeping;
+	Snapshot.BrokenLinkIndices = BrokenLinkIndices;
+	Snapshot.Encode(Positions, OldPositions);
+
+	LastSnapshotStep = SimulationStep;
+}
+
+bool UChainComponent::RestoreSnapshot(int64 Step)
+{
+	const FChainSnapshot* Snapshot = Snapshots.FindLatest(Step);
+	if (! Snapshot || Snapshot->Num() != Positions.Num()) return false;
+
+	Snapshot->Decode(Positions, OldPositions);
+
+	SimulationStep = Snapshot->Step;
+	LastSnapshotStep = Snapshot->Step;
+	TimeAccumulator = Snapshot->TimeAccumulator;
+	Frame = Snapshot->Frame;
+	RestingSteps = Snapshot->RestingSteps;
+	bSleeping = Snapshot->bSleeping;
+
+	if (bSleeping)
+	{
+		SleepBounds = FBox(Positions).ExpandBy(ChainWidth);
+	}
+
+	// Links broken after the snapshot are joined again, replays and kill cams show the chain before the break.
+	if (Snapshot->BrokenLinkIndices != BrokenLinkIndices)
+	{
+		BrokenLinks.Init(false, Positions.Num());
+		BrokenLinkIndices = Snapshot->BrokenLinkIndices;
+
+		for (const int32 LinkIndex : BrokenLinkIndices)
+		{
+			BrokenLinks[LinkIndex] = true;
+		}
+
+		RebuildSimulatedIndices(SimulatedStride);
+	}
+
+	// Forces, sweeps, contacts and break events in flight belong to the discarded steps.
+	FMemory::Memzero(Forces.GetData(), Forces.Num() * sizeof(FVector));
+	PendingSweeps.Reset();
+	PendingContacts.Reset();
+	PendingBrokenLinks.Reset();
+
+	// The recorded run consumed sweeps in the next step, the replay issues them blocking instead of skipping the world.
+	bAsyncSweepsDiscarded = true;
+
+	Snapshots.DiscardAfter(SimulationStep);
+
+	PreviousPositions = Positions;
+	RenderPositions = Positions;
+	InvalidateQueryCache();
+	UpdateOrientations();
+	bRenderDirty = true;
+
+	return true;
+}
+
+void UChainComponent::ResizeChainBuffers(int32 NumPoints)
+{
+	Positions.Reset(NumPoints);
+	OldPositions.Reset(NumPoints);
+	Forces.Reset(NumPoints);
+	FreeFlags.Reset(NumPoints);
+	Velocities.Reset(NumPoints);
+	Directions.Reset(NumPoints);
+	Rotations.Reset(NumPoints);
+	PointTimes.Reset(NumPoints);
+	PreviousPositions.Reset(NumPoints);
+	RenderPositions.Reset(NumPoints);
+
+	Positions.AddZeroed(NumPoints);
+	OldPositions.AddZeroed(NumPoints);
+	Forces.AddZeroed(NumPoints);
+	FreeFlags.Init(true, NumPoints);
+	Velocities.AddZeroed(NumPoints);
+	Directions.AddZeroed(NumPoints);
+	Rotations.AddZeroed(NumPoints);
+	PointTimes.AddZeroed(NumPoints);
+	PreviousPositions.AddZeroed(NumPoints);
+	RenderPositions.AddZeroed(NumPoints);
+
+	// Targets of the previous layout would index the wrong points, subclasses fill them again.
+	FollowTargets.Reset();
+	FollowStiffness.Reset();
+
+	// A new layout starts intact.
+	BrokenLinks.Init(false, NumPoints);
+	BrokenLinkIndices.Reset();
+	PendingBrokenLinks.Reset();
+
+	InvalidateQueryCache();
+
+	RebuildSimulatedIndices(SimulatedStride);
+}
+
+void UChainComponent::DrawChainPoints()
+{
+#if WITH_EDITOR
+	if (! bDrawDebugger || Positions.Num() < 2) return;
+
+	const int32 LineEndMultiply = 5;
+	const int32 SphereSegments = 4;
+	const int32 SphereWidthMultiply = 2;
+
+	DrawDebugSphere(GetWorld(), Positions[0], ChainWidth * SphereWidthMultiply, SphereSegments, FColor::Green);
+
+	for (int32 i = 1; i < Positions.Num() - 1; i++)
+	{
+		DrawDebugSphere(GetWorld(), Positions[i], ChainWidth, SphereSegments, FColor::Red);
+		FVector Forward = FVector::CrossProduct(Directions[i], FVector::ForwardVector);
+		FVector Right = FVector::CrossProduct(Directions[i], Forward);
+		DrawDebugLine(GetWorld(), Positions[i], Positions[i] + Directions[i] * LineEndMultiply, FColor::Red);
+		DrawDebugLine(GetWorld(), Positions[i], Positions[i] + Forward * LineEndMultiply, FColor::Green);
+		DrawDebugLine(GetWorld(), Positions[i], Positions[i] + Right * LineEndMultiply, FColor::Blue);
+	}
+
+	DrawDebugSphere(GetWorld(), Positions.Last(), ChainWidth * SphereWidthMultiply, SphereSegments, FColor::Green, false, -1, 0, 2);
+#endif
+}
+
+void UChainComponent::UpdateAttachments()
+{
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Attachments);
+
+	const TArray<FVector>& RenderedPositions = GetRenderPositions();
+
+	if (RenderedPositions.Num() > 0)
+	{
+		if (USceneComponent* AttachToStart = ResolveAttachment(AttachComponentToStartCache, AttachComponentToStart, NAME_None))
+		{
+			if (RotateStartAttachment)
+			{
+				AttachToStart->SetWorldLocationAndRotationNoPhysics(RenderedPositions[0], Rotations[0]);
+			}
+			else
+			{
+				AttachToStart->SetWorldLocation(RenderedPositions[0]);
+			}
+		}
+
+		if (USceneComponent* AttachToEnd = ResolveAttachment(AttachComponentToEndCache, AttachComponentToEnd, NAME_None))
+		{
+			if (bRotateEndAttachment)
+			{
+				AttachToEnd->SetWorldLocationAndRotationNoPhysics(RenderedPositions.Last(), Rotations.Last());
+			}
+			else
+			{
+				AttachToEnd->SetWorldLocation(RenderedPositions.Last());
+			}
+		}
+	}
+}
+
+bool UChainComponent::PreSimulate(float DeltaTime)
+{
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Pins);
+
+	Frame++;
+	NumSubsteps = 0;
+
+	if (Positions.Num() < 2) return false;
+
+	if (IsReplicationAuthority())
+	{
+		UpdateNetLOD();
+	}
+
+	const FChainLODSettings& LOD = GetActiveLODSettings();
+	const int32 Interval = GetStepInterval();
+
+	if (Interval <= 0)
+	{
+		TimeAccumulator = 0.0f;
+		UpdateFrozenPins();
+		return false;
+	}
+
+	// Skipped frames keep accumulating, so the chain catches up with the time they covered.
+	if (! bSleeping)
+	{
+		TimeAccumulator += DeltaTime;
+		bRenderDirty |= ShouldInterpolate();
+	}
+
+	if (Frame % Interval != 0) return false;
+
+	ChainEnd = GetChainEndPoint();
+
+	CalculateChainPoint(AttachStart, AttachStartTo, AttachStartCache, AttachStartToSocket, 0);
+	CalculateChainPoint(AttachEnd, AttachEndTo, AttachEndCache, AttachEndToSocket, Positions.Num() - 1, true);
+
+	const bool bInForceField = GatherForceFields();
+	const bool bCorrected = IsReplicationClient() && ApplyReplicatedKeyframes();
+
+	if (bSleeping)
+	{
+		// Sleeping chains do not integrate, so their old positions still hold the pins they fell asleep with.
+		// Comparing against them also catches attachments creeping by less than the tolerance every frame.
+		const bool bAttachmentsMoved = ! Positions[0].Equals(OldPositions[0], SleepAttachmentTolerance) || ! Positions.Last().Equals(OldPositions.Last(), SleepAttachmentTolerance);
+
+		if (! bAttachmentsMoved && ! bInForceField && ! bCorrected && ! ProbeForWake())
+		{
+			INC_DWORD_STAT(STAT_ChainSleepingChains);
+			return false;
+		}
+
+		WakeChain();
+		TimeAccumulator = DeltaTime;
+	}
+
+	// Pins of sleeping chains move less than the sleep tolerance, so their cached bounds stay valid.
+	InvalidateQueryCache();
+
+	NumSubsteps = ConsumeSubsteps();
+	if (NumSubsteps == 0) return false;
+
+	INC_DWORD_STAT_BY(STAT_ChainSubsteps, NumSubsteps);
+
+	bRenderDirty = true;
+	GravityStep = GetGravityStep();
+
+	if (FMath::Max(LOD.SegmentStride, 1) != SimulatedStride)
+	{
+		RebuildSimulatedIndices(LOD.SegmentStride);
+	}
+
+	return true;
+}
+
+int32 UChainComponent::ConsumeSubsteps()
+{
+	if (SubstepRate <= 0.0f)
+	{
+		TimeAccumulator = 0.0f;
+		return 1;
+	}
+
+	const float SubstepTime = 1.0f / SubstepRate;
+	const int32 AvailableSubsteps = FMath::FloorToInt32(TimeAccumulator / SubstepTime);
+
+	if (AvailableSubsteps > MaxSubsteps)
+	{
+		TimeAccumulator = 0.0f;
+		return FMath::Max(MaxSubsteps, 1);
+	}
+
+	TimeAccumulator -= AvailableSubsteps * SubstepTime;
+	return AvailableSubsteps;
+}
+
+void UChainComponent::Simulate()
+{
+	LastSolverIterations = 0;
+
+	if (HasFollowTargets())
+	{
+		UpdateFollowIterationStiffness(GetSolverIterations() + 1);
+	}
+
+	for (int32 Substep = 0; Substep < NumSubsteps; Substep++)
+	{
+		SimulationStep++;
+
+		if (Substep == NumSubsteps - 1 && ShouldInterpolate())
+		{
+			FMemory::Memcpy(PreviousPositions.GetData(), Positions.GetData(), Positions.Num() * sizeof(FVector));
+		}
+
+		if (ForceFields.Num() > 0 || PendingImpulses.Num() > 0)
+		{
+			ApplyForceFields(Substep == 0);
+		}
+
+		switch (SolverBackend)
+		{
+			case EChainSolverBackend::Vectorized:
+				SolveVectorized();
+				LastSolverIterations += GetSolverIterations() + 1;
+				break;
+
+			case EChainSolverBackend::XPBD:
+			case EChainSolverBackend::XPBDRedBlack:
+				SolveXPBD();
+				break;
+
+			default:
+				ApplyGravity();
+				SolveConstraint();
+				LastSolverIterations += GetSolverIterations() + 1;
+				break;
+		}
+	}
+
+	DetectBreaks();
+
+	LastSolverResidual = ChainSolver::MeasureResidual(Positions, SimulatedIndices, SegmentLength, BrokenConstraints);
+
+	if (SimulatedStride > 1)
+	{
+		InterpolateSkippedPoints();
+	}
+
+	UpdateOrientations();
+}
+
+void UChainComponent::PostSimulate()
+{
+	INC_DWORD_STAT_BY(STAT_ChainSolverIterations, LastSolverIterations);
+
+	ResolveCollision();
+	UpdateSleepState();
+	InvalidateQueryCache();
+
+	// A chain falling asleep sends its final pose right away, it will not step again for a while.
+	if (IsReplicationAuthority())
+	{
+		UpdateReplicatedKeyframes(bSleeping);
+	}
+
+	if (SnapshotCapacity > 0 && (LastSnapshotStep == INDEX_NONE || SimulationStep - LastSnapshotStep >= SnapshotInterval))
+	{
+		CaptureSnapshot();
+	}
+
+	// Batched chains are dispatched by the subsystem within the world-wide event budget.
+	if (! bRegisteredWithSubsystem)
+	{
+		DispatchEvents();
+	}
+}
+
+void UChainComponent::UpdateRender()
+{
+	if (! bRenderDirty) return;
+	bRenderDirty = false;
+
+	if (ShouldInterpolate())
+	{
+		const float Alpha = FMath::Clamp(TimeAccumulator * SubstepRate, 0.0f, 1.0f);
+
+		for (int32 i = 0; i < Positions.Num(); i++)
+		{
+			RenderPositions[i] = FMath::Lerp(PreviousPositions[i], Positions[i], Alpha);
+		}
+	}
+
+	if (RenderMode == EChainRenderMode::Cable)
+	{
+		PackRenderPoints();
+	}
+	else
+	{
+		UpdateMeshes();
+	}
+
+	UpdateAttachments();
+
+	if (Positions.Num() > 0)
+	{
+		RenderedStart = Positions[0];
+		RenderedEnd = Positions.Last();
+	}
+}
+
+void UChainComponent::UpdateFrozenPins()
+{
+	ChainEnd = GetChainEndPoint();
+
+	CalculateChainPoint(AttachStart, AttachStartTo, AttachStartCache, AttachStartToSocket, 0);
+	CalculateChainPoint(AttachEnd, AttachEndTo, AttachEndCache, AttachEndToSocket, Positions.Num() - 1, true);
+
+	// The render bounds have to follow the attachments, otherwise a chain carried into view is never rendered and stays frozen.
+	if (Positions[0].Equals(RenderedStart, SleepAttachmentTolerance) && Positions.Last().Equals(RenderedEnd, SleepAttachmentTolerance)) return;
+
+	PreviousPositions[0] = Positions[0];
+	PreviousPositions.Last() = Positions.Last();
+
+	InvalidateQueryCache();
+	bRenderDirty = true;
+}
+
+void UChainComponent::PackRenderPoints()
+{
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Meshes);
+
+	const TArray<FVector>& RenderedPositions = GetRenderPositions();
+	const FTransform& ComponentTransform = GetComponentTransform();
+
+	PackedRenderPoints.SetNumUninitialized(RenderedPositions.Num(), EAllowShrinking::No);
+
+	for (int32 i = 0; i < RenderedPositions.Num(); i++)
+	{
+		PackedRenderPoints[i] = FVector3f(ComponentTransform.InverseTransformPosition(RenderedPositions[i]));
+	}
+
+	// The proxy is created without a render device, the packed buffer is still kept up to date.
+	UpdateBounds();
+	MarkRenderTransformDirty();
+	MarkRenderDynamicDataDirty();
+}
+
+FPrimitiveSceneProxy* UChainComponent::CreateSceneProxy()
+{
+	if (RenderMode != EChainRenderMode::Cable) return Super::CreateSceneProxy();
+
+	return new FChainSceneProxy(this);
+}
+
+void UChainComponent::SendRenderDynamicData_Concurrent()
+{
+	Super::SendRenderDynamicData_Concurrent();
+
+	if (! SceneProxy || RenderMode != EChainRenderMode::Cable) return;
+
+	FChainSceneProxy* ChainProxy = static_cast<FChainSceneProxy*>(SceneProxy);
+
+	ENQUEUE_RENDER_COMMAND(ChainSetPoints)([ChainProxy, Points = PackedRenderPoints, Breaks = BrokenLinkIndices](FRHICommandListImmediate& RHICmdList) mutable
+	{
+		ChainProxy->SetPoints_RenderThread(MoveTemp(Points), MoveTemp(Breaks));
+	});
+}
+
+FBoxSphereBounds UChainComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (RenderMode != EChainRenderMode::Cable || PackedRenderPoints.Num() == 0) return Super::CalcBounds(LocalToWorld);
+
+	FBox LocalBox(ForceInit);
+
+	for (const FVector3f& Point : PackedRenderPoints)
+	{
+		LocalBox += FVector(Point);
+	}
+
+	return FBoxSphereBounds(LocalBox.ExpandBy(CableRadius)).TransformBy(LocalToWorld);
+}
+
+void UChainComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T BufferSize = 0;
+
+	BufferSize += Positions.GetAllocatedSize() + OldPositions.GetAllocatedSize() + Forces.GetAllocatedSize() + FreeFlags.GetAllocatedSize();
+	BufferSize += Velocities.GetAllocatedSize() + Directions.GetAllocatedSize() + Rotations.GetAllocatedSize() + PointTimes.GetAllocatedSize();
+	BufferSize += PreviousPositions.GetAllocatedSize() + RenderPositions.GetAllocatedSize() + SimulatedIndices.GetAllocatedSize();
+	BufferSize += FollowTargets.GetAllocatedSize() + FollowStiffness.GetAllocatedSize() + FollowIterationStiffness.GetAllocatedSize();
+	BufferSize += UploadedTransforms.GetAllocatedSize() + InstanceRunTransforms.GetAllocatedSize() + PackedRenderPoints.GetAllocatedSize();
+	BufferSize += PendingSweeps.GetAllocatedSize() + SweepHits.GetAllocatedSize() + PendingContacts.GetAllocatedSize() + DispatchedContacts.GetAllocatedSize();
+	BufferSize += CumulativeLengths.GetAllocatedSize() + RestPose.GetAllocatedSize() + Snapshots.GetAllocatedSize();
+	BufferSize += BrokenLinks.GetAllocatedSize() + BrokenLinkIndices.GetAllocatedSize() + BrokenConstraints.GetAllocatedSize();
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(BufferSize);
+}
+
+int32 UChainComponent::GetNumMaterials() const
+{
+	return RenderMode == EChainRenderMode::Cable ? 1 : Super::GetNumMaterials();
+}
+
+void UChainComponent::GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials) const
+{
+	Super::GetUsedMaterials(OutMaterials, bGetDebugMaterials);
+
+	if (RenderMode == EChainRenderMode::Cable)
+	{
+		if (UMaterialInterface* CableMaterial = GetCableMaterial())
+		{
+			OutMaterials.AddUnique(CableMaterial);
+		}
+	}
+}
+
+UMaterialInterface* UChainComponent::GetCableMaterial() const
+{
+	if (UMaterialInterface* OverrideMaterial = GetMaterial(0))
+	{
+		return OverrideMaterial;
+	}
+
+	return ChainMesh ? ChainMesh->GetMaterial(0) : nullptr;
+}
+
+void UChainComponent::UpdateSleepState()
+{
+	if (! bAllowSleep) return;
+
+	double Energy = 0.0;
+	int32 NumFree = 0;
+
+	for (int32 i = 0; i < Positions.Num(); i++)
+	{
+		if (! FreeFlags[i]) continue;
+
+		// Pending forces mean the chain is about to move, it can not be at rest.
+		if (! Forces[i].IsNearlyZero())
+		{
+			RestingSteps = 0;
+			return;
+		}
+
+		Energy += FVector::DistSquared(Positions[i], OldPositions[i]);
+		NumFree++;
+	}
+
+	Energy /= FMath::Max(NumFree, 1);
+	RestingSteps = Energy < SleepEnergyThreshold ? RestingSteps + 1 : 0;
+
+	if (RestingSteps >= SleepFrames)
+	{
+		bSleeping = true;
+
+		// Drop the residual velocity so the chain does not jump when it wakes up.
+		OldPositions = Positions;
+		PreviousPositions = Positions;
+
+		SleepBounds = FBox(Positions).ExpandBy(ChainWidth);
+	}
+}
 
-UChainComponent::UChainComponent(const FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
+bool UChainComponent::ProbeForWake()
 {
-	PrimaryComponentTick.bCanEverTick = true;
-	bTickInEditor = true;
-	bAutoActivate = true;
-	InstanceComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("InstanceComponent"));
-	InstanceComponent->InstancingRandomSeed = FMath::Rand();
+	if (WakeProbeInterval <= 0 || Frame % WakeProbeInterval != 0 || ! SleepBounds.IsValid) return false;
+
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(ChainWakeProbe));
+	Params.AddIgnoredActor(GetOwner());
+
+	WakeProbeOverlaps.Reset();
+	GetWorld()->OverlapMultiByObjectType(WakeProbeOverlaps, SleepBounds.GetCenter(), FQuat::Identity, FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllDynamicObjects), FCollisionShape::MakeBox(SleepBounds.GetExtent()), Params);
+
+	for (const FOverlapResult& Overlap : WakeProbeOverlaps)
+	{
+		const UPrimitiveComponent* Component = Overlap.GetComponent();
+
+		if (Component && Component->GetComponentVelocity().SizeSquared() > FMath::Square(ChainSleep::WakeProbeSpeed))
+		{
+			return true;
+		}
+	}
+
+	return false;
 }
 
-void UChainComponent::OnRegister()
+UChainSimulationSubsystem* UChainComponent::GetSimulationSubsystem() const
 {
-	Super::OnRegister();
+	if (! bUseSimulationSubsystem) return nullptr;
 
-	InitChain();
+	return UWorld::GetSubsystem<UChainSimulationSubsystem>(GetWorld());
 }
 
-void UChainComponent::OnUnregister()
+FVector UChainComponent::GetGravityStep() const
 {
-	Super::OnUnregister();
+	constexpr float GravityScale = 1000.0f;
+	const FVector Step(0, 0, GetWorld()->GetGravityZ() * Gravity / GravityScale);
 
-	InstanceComponent->ClearInstances();
-	ChainPoints.Empty();
+	// Verlet displacement scales with the squared step time.
+	return SubstepRate > 0.0f ? Step * FMath::Square(ChainSubstep::ReferenceRate / SubstepRate) : Step;
 }
 
-void UChainComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UChainComponent::ApplyGravity()
 {
-	Frame++;
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Gravity);
+
+	const FVector GravityVector = GravityStep;
+
+	FVector* RESTRICT Position = Positions.GetData();
+	FVector* RESTRICT OldPosition = OldPositions.GetData();
+	FVector* RESTRICT Velocity = Velocities.GetData();
+	const bool* RESTRICT Free = FreeFlags.GetData();
 
-	if (Frame > 0 && (Skip + 1) > 0)
+	for (const int32 i : SimulatedIndices)
 	{
-		if (Frame % (Skip + 1) == 0)
+		if (Free[i])
 		{
-			CalculatePoints();
+			const FVector PointVelocity = (Position[i] - OldPosition[i]) + GravityVector;
+			OldPosition[i] = Position[i];
+			Position[i] += PointVelocity;
+			Velocity[i] = PointVelocity;
 		}
 	}
+}
 
-	DrawChainPoints();
+bool UChainComponent::GatherForceFields()
+{
+	ForceFields.Reset();
+
+	const UChainSimulationSubsystem* Subsystem = UWorld::GetSubsystem<UChainSimulationSubsystem>(GetWorld());
+	if (! Subsystem || ! Subsystem->HasForceFields()) return PendingImpulses.Num() > 0;
+
+	Subsystem->GatherForceFields(GetChainBounds(), ForceFields, PendingImpulses, AppliedImpulseSerial);
+	ForceFieldTime = GetWorld()->GetTimeSeconds();
+
+	return ForceFields.Num() > 0 || PendingImpulses.Num() > 0;
 }
 
-void UChainComponent::BeginPlay()
+void UChainComponent::ApplyForceFields(bool bApplyImpulses)
 {
-	Super::BeginPlay();
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Gravity);
 
-	if (HasBegunPlay())
+	const float StepTime = 1.0f / (SubstepRate > 0.0f ? SubstepRate : ChainSubstep::ReferenceRate);
+
+	// Verlet displacement: accelerations scale with the squared step time, velocity changes with the step time.
+	const float FieldScale = FMath::Square(StepTime);
+
+	const FVector* RESTRICT Position = Positions.GetData();
+	FVector* RESTRICT Force = Forces.GetData();
+	const bool* RESTRICT Free = FreeFlags.GetData();
+
+	// One field at a time over all points, so every field is dispatched once per step instead of once per point.
+	for (const FChainForceField& Field : ForceFields)
 	{
-		InitChain();
+		for (const int32 i : SimulatedIndices)
+		{
+			if (Free[i])
+			{
+				Force[i] -= Field.Sample(Position[i], ForceFieldTime) * FieldScale;
+			}
+		}
 	}
-}
 
-TArray<int> UChainComponent::ApplyForce(FVector InPosition, float InRadius, FVector InForce)
-{
-	TArray<int> AffectedPoints;
-	for (auto& Point : ChainPoints)
+	if (! bApplyImpulses) return;
+
+	for (const FChainForceField& Impulse : PendingImpulses)
 	{
-		if ((InPosition - Point.Position).Size() <= InRadius)
+		for (const int32 i : SimulatedIndices)
 		{
-			AffectedPoints.Add(Point.Index);
-			Point.Force -= InForce;
+			if (Free[i])
+			{
+				Force[i] -= Impulse.Sample(Position[i], ForceFieldTime) * StepTime;
+			}
 		}
 	}
 
-	return AffectedPoints;
+	PendingImpulses.Reset();
 }
 
-FVector UChainComponent::GetChainPoint(int index)
+void UChainComponent::SolveConstraint()
 {
-	return ChainPoints.Num() > index ? ChainPoints[index].Position : FVector::ZeroVector;
-}
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Constraints);
 
-void UChainComponent::AttachStartToActor(FComponentReference ComponentReference, FName Socket)
-{
-	AttachStartTo = ComponentReference;
-	AttachStartToSocket = Socket;
-	AttachStart = true;
+	const int32 Iterations = GetSolverIterations();
+	const int32 NumSegments = SimulatedIndices.Num() - 1;
+	const int32* Index = SimulatedIndices.GetData();
+	const bool* Broken = BrokenConstraints.Num() > 0 ? BrokenConstraints.GetData() : nullptr;
+
+	// The first pass consumes the accumulated forces, every following pass only stiffens the chain.
+	for (int i = 0; i <= Iterations; i++)
+	{
+		for (int32 j = 0; j < NumSegments; j++)
+		{
+			if (Broken && Broken[j]) continue;
+
+			UpdatePoint(Index[j], Index[j + 1], SegmentLength * (Index[j + 1] - Index[j]));
+		}
+
+		if (! (Broken && Broken[NumSegments - 1]))
+		{
+			UpdatePoint(Index[NumSegments], Index[NumSegments - 1], SegmentLength * (Index[NumSegments] - Index[NumSegments - 1]));
+		}
+
+		// Points cut loose on both sides are not reached by UpdatePoint, they consume their forces on their own.
+		if (i == 0 && Broken)
+		{
+			for (int32 j = 0; j <= NumSegments; j++)
+			{
+				const int32 Point = Index[j];
+				const bool bLinked = (j > 0 && ! Broken[j - 1]) || (j < NumSegments && ! Broken[j]);
+				if (bLinked || ! FreeFlags[Point]) continue;
+
+				Positions[Point] -= Forces[Point];
+				Forces[Point] = FVector::ZeroVector;
+			}
+		}
+
+		if (HasFollowTargets())
+		{
+			ChainSolver::SolveFollow(Positions, FreeFlags, SimulatedIndices, FollowTargets, FollowIterationStiffness);
+		}
+	}
 }
 
-void UChainComponent::AttachEndToActor(FComponentReference ComponentReference, FName Socket)
+void UChainComponent::SolveVectorized()
 {
-	AttachEndTo = ComponentReference;
-	AttachEndToSocket = Socket;
-	AttachEnd = true;
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Constraints);
+
+	const bool bFollow = HasFollowTargets();
+
+	VectorSolver.Gather(Positions, OldPositions, Forces, FreeFlags, SimulatedIndices, SegmentLength, bFollow ? FollowTargets : TConstArrayView<FVector>(), bFollow ? FollowIterationStiffness : TConstArrayView<float>(), BrokenConstraints);
+	VectorSolver.Integrate(GravityStep);
+	VectorSolver.SolveDistance(GetSolverIterations() + 1);
+	VectorSolver.Scatter(Positions, OldPositions, Forces, Velocities, FreeFlags);
 }
 
-void UChainComponent::InitChain()
+void UChainComponent::SolveXPBD()
 {
-	InstanceComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	ChainPoints.Reset();
-	ChainPoints.AddUninitialized(Segments);
+	ApplyGravity();
 
-	ChainStart = GetComponentLocation();
-	ChainEnd = GetChainEndPoint();
+	{
+		FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Gravity);
+		ApplyExternalForces();
+	}
 
-	const FVector LengthVector = ChainEnd - ChainStart;
-	InstanceComponent->SetStaticMesh(ChainMesh);
-	InstanceComponent->ClearInstances();
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Constraints);
+
+	FChainXPBDSettings Settings;
+	Settings.Iterations = GetSolverIterations() + 1;
+	Settings.Compliance = Compliance;
+	Settings.TimeStep = 1.0f / (SubstepRate > 0.0f ? SubstepRate : ChainSubstep::ReferenceRate);
+	Settings.Tolerance = SolverTolerance;
+	Settings.bRedBlack = SolverBackend == EChainSolverBackend::XPBDRedBlack;
+	Settings.ParallelBatchSize = ParallelBatchSize;
 
-	if (InstanceComponent->GetInstanceCount() == 0)
+	const bool bFollow = HasFollowTargets();
+
+	const FChainXPBDSolver::FResult Result = XPBDSolver.Solve(Positions, FreeFlags, SimulatedIndices, SegmentLength, Settings, bFollow ? FollowTargets : TConstArrayView<FVector>(), bFollow ? FollowIterationStiffness : TConstArrayView<float>(), BrokenConstraints);
+	LastSolverIterations += Result.Iterations;
+}
+
+void UChainComponent::UpdateFollowIterationStiffness(int32 Iterations)
+{
+	FollowIterationStiffness.SetNumZeroed(Positions.Num(), EAllowShrinking::No);
+
+	for (const int32 i : SimulatedIndices)
 	{
-		float SegmentTime = 1.0f / static_cast<float>(Segments);
-		SegmentLength = (LengthVector.Size() / static_cast<float>(Segments)) * ChainLength;
+		FollowIterationStiffness[i] = ChainSolver::GetIterationStiffness(FollowStiffness[i], Iterations);
+	}
+}
 
-		for (int i = 0; i < Segments; i++)
+void UChainComponent::ApplyExternalForces()
+{
+	for (const int32 i : SimulatedIndices)
+	{
+		if (FreeFlags[i])
 		{
-			FChainPointData ChainPoint;
-			ChainPoint.Time = i * SegmentTime;
-			ChainPoint.Index = i;
-			ChainPoint.Position = ChainStart + ((static_cast<float>(i) / static_cast<float>(Segments)) * LengthVector);
-			ChainPoint.OldPosition = ChainPoint.Position;
-			ChainPoint.Transform.SetScale3D(Scale);
-
-			ChainPoints[i] = ChainPoint;
-			InstanceComponent->AddInstance(ChainPoint.Transform);
+			Positions[i] -= Forces[i];
+			Forces[i] = FVector::ZeroVector;
 		}
 	}
 }
 
-void UChainComponent::DrawChainPoints()
+void UChainComponent::ResolveCollision()
 {
-#if WITH_EDITOR
-	if (! bDrawDebugger || ChainPoints.Num() < 2) return;
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Collision);
 
-	const int32 LineEndMultiply = 5;
-	const int32 SphereSegments = 4;
-	const int32 SphereWidthMultiply = 2;
+	if (GetCollisionEnabled() == ECollisionEnabled::NoCollision || ! GetActiveLODSettings().bEnableCollision) return;
 
-	DrawDebugSphere(GetWorld(), ChainPoints[0].Position, ChainWidth * SphereWidthMultiply, SphereSegments, FColor::Green);
+	if (bSelfCollision)
+	{
+		ResolveSelfCollision();
+	}
 
-	for (int32 i = 1; i < ChainPoints.Num() - 1; i++)
+	if (CollisionQueryMode == EChainCollisionQueryMode::Async)
+	{
+		ConsumeAsyncSweeps();
+		SubmitAsyncSweeps();
+	}
+	else
 	{
-		DrawDebugSphere(GetWorld(), ChainPoints[i].Position, ChainWidth, SphereSegments, FColor::Red);
-		FVector Forward = FVector::CrossProduct(ChainPoints[i].Direction, FVector::ForwardVector);
-		FVector Right = FVector::CrossProduct(ChainPoints[i].Direction, Forward);
-		DrawDebugLine(GetWorld(), ChainPoints[i].Position, ChainPoints[i].Position + ChainPoints[i].Direction * LineEndMultiply, FColor::Red);
-		DrawDebugLine(GetWorld(), ChainPoints[i].Position, ChainPoints[i].Position + Forward * LineEndMultiply, FColor::Green);
-		DrawDebugLine(GetWorld(), ChainPoints[i].Position, ChainPoints[i].Position + Right * LineEndMultiply, FColor::Blue);
+		SweepPointsSynchronous();
 	}
 
-	DrawDebugSphere(GetWorld(), ChainPoints.Last().Position, ChainWidth * SphereWidthMultiply, SphereSegments, FColor::Green, false, -1, 0, 2);
-#endif
+	if (! OnSoundReached.IsBound() || SoundSkip <= 0 || Frame % SoundSkip != 0) return;
+
+	FVector Velocity = FVector::ZeroVector;
+
+	for (const FVector& PointVelocity : Velocities)
+	{
+		Velocity += PointVelocity;
+	}
+
+	const double VelocitySquared = Velocity.SizeSquared();
+
+	if (VelocitySquared > FMath::Square(SoundThreshold) && (! bSoundPending || VelocitySquared > PendingSoundVelocity.SizeSquared()))
+	{
+		PendingSoundVelocity = Velocity;
+		bSoundPending = true;
+	}
 }
 
-void UChainComponent::UpdateAttachments()
+void UChainComponent::AddContact(const FHitResult& Hit)
 {
-	if (ChainPoints.Num() > 0)
+	for (FHitResult& Contact : PendingContacts)
 	{
-		if (AttachComponentToStart.OtherActor != nullptr)
-		{
-			USceneComponent* AttachToStart = Cast<USceneComponent>(AttachComponentToStart.GetComponent(GetOwner()));
-
-			if (AttachToStart)
-			{
-				if (RotateStartAttachment)
-				{
-					AttachToStart->SetWorldLocationAndRotationNoPhysics(ChainPoints[0].Position, ChainPoints[0].Rotation);
-				}
-				else
-				{
-					AttachToStart->SetWorldLocation(ChainPoints[0].Position);
-				}
-			}
-		}
-		if (AttachComponentToEnd.OtherActor != nullptr)
+		if (Contact.Component == Hit.Component)
 		{
-			USceneComponent* AttachToEnd = Cast<USceneComponent>(AttachComponentToEnd.GetComponent(GetOwner()));
-			AttachToEnd->SetWorldLocationAndRotationNoPhysics(ChainPoints.Last().Position, ChainPoints.Last().Rotation);
-
-			if (AttachToEnd)
-			{
-				if (bRotateEndAttachment)
-				{
-					AttachToEnd->SetWorldLocationAndRotationNoPhysics(ChainPoints[0].Position, ChainPoints[0].Rotation);
-				}
-				else
-				{
-					AttachToEnd->SetWorldLocation(ChainPoints[0].Position);
-				}
-			}
+			Contact = Hit;
+			return;
 		}
 	}
+
+	PendingContacts.Add(Hit);
 }
 
-void UChainComponent::CalculatePoints()
+int32 UChainComponent::DispatchEvents()
 {
-	if (ChainPoints.Num() < 2) return;
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Events);
 
-	ChainEnd = GetChainEndPoint();
+	const double Now = GetWorld()->GetTimeSeconds();
+	int32 NumEvents = 0;
 
-	CalculateChainPoint(AttachStart, AttachStartTo, AttachStartToSocket, 0);
-	CalculateChainPoint(AttachEnd, AttachEndTo, AttachEndToSocket, ChainPoints.Num() - 1, true);
+	if (PendingContacts.Num() > 0 && Now - LastCollideEventTime >= CollisionEventInterval)
+	{
+		LastCollideEventTime = Now;
+		NumEvents++;
 
-	ApplyGravity();
-	SolveConstraint();
-	ResolveCollision();
-	UpdateMeshes();
-	UpdateAttachments();
+		// Handlers may move the chain and collect new contacts, so the broadcast array is swapped out first.
+		Swap(PendingContacts, DispatchedContacts);
+		PendingContacts.Reset();
+		OnCollide.Broadcast(DispatchedContacts);
+	}
+
+	if (bSoundPending && Now - LastSoundEventTime >= SoundEventInterval)
+	{
+		LastSoundEventTime = Now;
+		NumEvents++;
+
+		bSoundPending = false;
+		OnSoundReached.Broadcast(PendingSoundVelocity);
+	}
+
+	// Links broken by the handlers are broadcast in the same dispatch, a handler reinitializing the chain clears the rest.
+	for (int32 k = 0; k < PendingBrokenLinks.Num(); k++)
+	{
+		const int32 LinkIndex = PendingBrokenLinks[k];
+		if (! Positions.IsValidIndex(LinkIndex + 1)) continue;
+
+		NumEvents++;
+		OnChainBroken.Broadcast(LinkIndex, (Positions[LinkIndex] + Positions[LinkIndex + 1]) * 0.5);
+	}
+
+	PendingBrokenLinks.Reset();
+
+	return NumEvents;
 }
 
-void UChainComponent::ApplyGravity()
+void UChainComponent::ResolveSelfCollision()
 {
+	if (bSelfCollisionBroadphase)
+	{
+		ChainCollision::AccumulateSelfCollisionHashed(Positions, FreeFlags, SelfCollisionWidth, SelfCollisionThreshold, Forces, SelfCollisionHash);
+	}
+	else
+	{
+		ChainCollision::AccumulateSelfCollisionBruteForce(Positions, FreeFlags, SelfCollisionWidth, SelfCollisionThreshold, Forces);
+	}
+}
 
-	constexpr float GravityScale = 1000.0f;
-	const FVector GravityVector(0, 0, GetWorld()->GetGravityZ() * Gravity / GravityScale);
+int32 UChainComponent::ResolveChainCollision(const FChainCollisionWorld& World, int32 ChainIndex, int32 Budget)
+{
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Collision);
+
+	return World.Resolve(ChainIndex, SimulatedIndices, FreeFlags, Budget, Forces, ChainCollisionCursor);
+}
 
-	for (auto& Point : ChainPoints)
+void UChainComponent::SweepPointsSynchronous()
+{
+	for (int32 i = 0; i < Positions.Num(); i++)
 	{
-		if (Point.bFree)
+		if (FreeFlags[i])
 		{
-			FVector Velocity = (Point.Position - Point.OldPosition) + GravityVector;
-			Point.OldPosition = Point.Position;
-			Point.Position += Velocity;
-			Point.Velocity = Velocity;
+			SweepPoint(i);
 		}
 	}
 }
 
-void UChainComponent::SolveConstraint()
+void UChainComponent::SweepPoint(int32 PointIndex)
 {
-	const int32 NumSegments = ChainPoints.Num() - 1;
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(CableCollision));
+	FCollisionResponseParams ResponseParam(GetCollisionResponseToChannels());
+
+	SweepHits.Reset();
+	bool Hitted = GetWorld()->SweepMultiByChannel(SweepHits, Positions[PointIndex], Positions[PointIndex] + Velocities[PointIndex], FQuat::Identity, GetCollisionObjectType(), FCollisionShape::MakeSphere(0.5f * ChainWidth), Params, ResponseParam);
+
+	if (Hitted)
+	{
+		ApplyCollisionHits(PointIndex, SweepHits, false);
+	}
+}
 
-	for (int32 i = 0; i < NumSegments; i++)
+void UChainComponent::ConsumeAsyncSweeps()
+{
+	if (bAsyncSweepsDiscarded)
 	{
-		UpdatePoint(i, ChainPoints[i], ChainPoints[i + 1], SegmentLength, 1);
+		// A restored snapshot has no sweeps in flight, the first replayed step sweeps like for expired results.
+		bAsyncSweepsDiscarded = false;
+		SweepPointsSynchronous();
+		return;
 	}
 
-	UpdatePoint(NumSegments, ChainPoints[NumSegments - 1], ChainPoints[NumSegments], SegmentLength, 1);
+	UWorld* World = GetWorld();
+	FTraceDatum TraceData;
 
-	for (int i = 0; i < Stiffness; i++)
+	for (const FChainPendingSweep& Sweep : PendingSweeps)
 	{
-		for (int32 j = 0; j < NumSegments; j++)
+		if (! Positions.IsValidIndex(Sweep.PointIndex) || ! FreeFlags[Sweep.PointIndex]) continue;
+
+		if (World->QueryTraceData(Sweep.Handle, TraceData))
+		{
+			if (TraceData.OutHits.Num() > 0)
+			{
+				ApplyCollisionHits(Sweep.PointIndex, TraceData.OutHits, true);
+			}
+		}
+		else
 		{
-			UpdatePoint(j, ChainPoints[j], ChainPoints[j + 1], SegmentLength, 1);
+			// The result expired (skipped frames, pause) or was never produced, fall back to a blocking sweep.
+			SweepPoint(Sweep.PointIndex);
 		}
-
-		UpdatePoint(NumSegments, ChainPoints[NumSegments], ChainPoints[NumSegments - 1], SegmentLength, 1);
 	}
+
+	PendingSweeps.Reset();
 }
 
-void UChainComponent::ResolveCollision()
+void UChainComponent::SubmitAsyncSweeps()
 {
 	UWorld* World = GetWorld();
+	FCollisionQueryParams Params(SCENE_QUERY_STAT(CableCollision));
+	FCollisionResponseParams ResponseParam(GetCollisionResponseToChannels());
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(0.5f * ChainWidth);
 
-	if (GetCollisionEnabled() != ECollisionEnabled::NoCollision)
+	PendingSweeps.Reset(Positions.Num());
+
+	for (int32 i = 0; i < Positions.Num(); i++)
 	{
-		FCollisionQueryParams Params(SCENE_QUERY_STAT(CableCollision));
-		FCollisionResponseParams ResponseParam(GetCollisionResponseToChannels());
-		FVector Velocity = FVector::ZeroVector;
-		FVector Normal = FVector::ZeroVector;
-		FVector Position = FVector::ZeroVector;
+		if (! FreeFlags[i]) continue;
 
-		for (int32 i = 0; i < ChainPoints.Num(); i++)
-		{
-			if (ChainPoints[i].bFree)
-			{
-				if (bSelfCollision)
-				{
-					Normal = FVector::ZeroVector;
-					Position = ChainPoints[i].Position;
-
-					for (int32 j = 0; j < ChainPoints.Num(); j++)
-					{
-						int d = j - i;
-						if (i != j && abs(d) > 2)
-						{
-							const float dist = FVector::Dist(ChainPoints[i].Position, ChainPoints[j].Position);
-
-							if (abs(dist) < SelfCollisionWidth)
-							{
-								Normal = ChainPoints[i].Position - ChainPoints[j].Position;
-								Normal *= ((Normal.Size() - SelfCollisionWidth) / SelfCollisionWidth);
-								if (! Normal.IsNearlyZero(SelfCollisionThreshold))
-								{
-									ChainPoints[i].Force += Normal;
-								}
-							}
-						}
-					}
-				}
+		FChainPendingSweep& Sweep = PendingSweeps.AddDefaulted_GetRef();
+		Sweep.PointIndex = i;
+		Sweep.Handle = World->AsyncSweepByChannel(EAsyncTraceType::Multi, Positions[i], Positions[i] + Velocities[i], FQuat::Identity, GetCollisionObjectType(), Shape, Params, ResponseParam);
+	}
+}
 
-				TArray<FHitResult> HitResult;
-				bool Hitted = World->SweepMultiByChannel(HitResult, ChainPoints[i].Position, ChainPoints[i].Position + ChainPoints[i].Velocity, FQuat::Identity, GetCollisionObjectType(), FCollisionShape::MakeSphere(0.5f * ChainWidth), Params, ResponseParam);
+void UChainComponent::ApplyCollisionHits(int32 PointIndex, const TArray<FHitResult>& Hits, bool bDeferred)
+{
+	if (OnCollide.IsBound())
+	{
+		for (const FHitResult& Hit : Hits)
+		{
+			AddContact(Hit);
+		}
+	}
 
-				if (Hitted)
-				{
-					OnCollide.Broadcast(HitResult);
-
-					for (int32 j = 0; j < HitResult.Num(); j++)
-					{
-						if (HitResult[j].bStartPenetrating)
-						{
-							ChainPoints[i].Position += (HitResult[j].Normal * HitResult[j].PenetrationDepth);
-						}
-						else
-						{
-							ChainPoints[i].Position = HitResult[j].Location;
-						}
-
-						FVector Delta = ChainPoints[i].Position - ChainPoints[i].OldPosition;
-						float nDelta = Delta | HitResult[j].Normal;
-						FVector plane = Delta - (nDelta * HitResult[j].Normal);
-						ChainPoints[i].OldPosition += nDelta * HitResult[j].Normal;
-
-						if (Friction > KINDA_SMALL_NUMBER)
-						{
-							ChainPoints[i].OldPosition += plane * Friction;
-						}
-					}
-				}
+	for (const FHitResult& Hit : Hits)
+	{
+		if (Hit.bStartPenetrating)
+		{
+			Positions[PointIndex] += (Hit.Normal * Hit.PenetrationDepth);
+		}
+		else if (bDeferred)
+		{
+			// The hit was found for the previous position, only push the point back if it went behind the surface.
+			const float Depth = (Positions[PointIndex] - Hit.Location) | Hit.Normal;
+			if (Depth < 0)
+			{
+				Positions[PointIndex] -= Depth * Hit.Normal;
 			}
-			Velocity += ChainPoints[i].Velocity;
+		}
+		else
+		{
+			Positions[PointIndex] = Hit.Location;
 		}
 
-		if (Velocity.Size() > SoundThreshold && Frame % SoundSkip == 0)
+		FVector Delta = Positions[PointIndex] - OldPositions[PointIndex];
+		float nDelta = Delta | Hit.Normal;
+		FVector plane = Delta - (nDelta * Hit.Normal);
+		OldPositions[PointIndex] += nDelta * Hit.Normal;
+
+		if (Friction > KINDA_SMALL_NUMBER)
 		{
-			OnSoundReached.Broadcast(Velocity);
+			OldPositions[PointIndex] += plane * Friction;
 		}
 	}
 }
 
 void UChainComponent::UpdateMeshes()
 {
-	for (int32 i = 0; i < ChainPoints.Num(); i++)
+	SCOPE_CYCLE_COUNTER(STAT_ChainUpdateMeshes);
+	FChainPhaseScope PhaseScope(PhaseTimings, EChainPhase::Meshes);
+
+	const TArray<FVector>& RenderedPositions = GetRenderPositions();
+	const int32 NumPoints = FMath::Min(RenderedPositions.Num(), InstanceComponent->GetInstanceCount());
+	const bool bUploadAll = UploadedTransforms.Num() != NumPoints;
+
+	if (bUploadAll)
+	{
+		UploadedTransforms.SetNum(NumPoints);
+	}
+
+	int32 NumUploaded = 0;
+	int32 RunStart = INDEX_NONE;
+	InstanceRunTransforms.Reset();
+
+	for (int32 i = 0; i < NumPoints; i++)
 	{
-		FChainPointData& ChainPoint = ChainPoints[i];
+		const FTransform Transform(Rotations[i], RenderedPositions[i], Scale);
+
+		if (bUploadAll || ! Transform.Equals(UploadedTransforms[i], InstanceUpdateTolerance))
+		{
+			if (RunStart == INDEX_NONE) RunStart = i;
+
+			InstanceRunTransforms.Add(Transform);
+			UploadedTransforms[i] = Transform;
+			NumUploaded++;
+		}
+		else if (RunStart != INDEX_NONE)
+		{
+			FlushInstanceRun(RunStart, InstanceRunTransforms);
+			RunStart = INDEX_NONE;
+		}
+	}
 
-		ChainPoint.Transform.SetLocation(ChainPoint.Position);
-		ChainPoint.Transform.SetRotation(ChainPoint.Rotation.Quaternion());
+	if (RunStart != INDEX_NONE)
+	{
+		FlushInstanceRun(RunStart, InstanceRunTransforms);
+	}
 
-		InstanceComponent->UpdateInstanceTransform(i, ChainPoint.Transform, true, true);
+	if (NumUploaded > 0)
+	{
+		InstanceComponent->MarkRenderStateDirty();
 	}
+
+	INC_DWORD_STAT_BY(STAT_ChainInstancesUploaded, NumUploaded);
+}
+
+void UChainComponent::FlushInstanceRun(int32 StartIndex, TArray<FTransform>& RunTransforms)
+{
+	InstanceComponent->BatchUpdateInstancesTransforms(StartIndex, RunTransforms, true, false, false);
+	RunTransforms.Reset();
 }
 
-void UChainComponent::UpdatePoint(size_t i, FChainPointData& p1, FChainPointData& p2, float length, int offset)
+void UChainComponent::UpdatePoint(int32 A, int32 B, float Length)
 {
-	const FVector Delta = p2.Position - p1.Position;
+	const FVector Delta = Positions[B] - Positions[A];
 	if (Delta.IsNearlyZero()) return;
 
 	const float CurrentDistance = Delta.Size();
-	const float MaxDistance = (CurrentDistance - length) / CurrentDistance;
+	const float MaxDistance = (CurrentDistance - Length) / CurrentDistance;
+	const bool bFreeA = FreeFlags[A];
+	const bool bFreeB = FreeFlags[B];
 
-	if (p1.bFree && p2.bFree)
+	if (bFreeA && bFreeB)
 	{
 		FVector Force = MaxDistance * 0.5f * Delta;
-		p1.Position += Force + p1.Force;
-		p2.Position -= Force + p2.Force;
-		p1.Force = FVector::ZeroVector;
-		p2.Force = FVector::ZeroVector;
+		Positions[A] += Force + Forces[A];
+		Positions[B] -= Force + Forces[B];
+		Forces[A] = FVector::ZeroVector;
+		Forces[B] = FVector::ZeroVector;
 	}
-	else if (p1.bFree)
+	else if (bFreeA)
 	{
-		p1.Position += (MaxDistance * Delta) + p1.Force;
-		p1.Force = FVector::ZeroVector;
+		Positions[A] += (MaxDistance * Delta) + Forces[A];
+		Forces[A] = FVector::ZeroVector;
 	}
-	else if (p2.bFree)
+	else if (bFreeB)
 	{
-		p2.Position -= (MaxDistance * Delta) + p2.Force;
-		p2.Force = FVector::ZeroVector;
+		Positions[B] -= (MaxDistance * Delta) + Forces[B];
+		Forces[B] = FVector::ZeroVector;
 	}
+}
 
-	FVector Direction;
+void UChainComponent::UpdateOrientations()
+{
+	const int32 NumPoints = Positions.Num();
+	if (NumPoints < 2) return;
 
-	if (i == 0)
-	{
-		Direction = (ChainPoints[i + 1].Position - p1.Position).GetUnsafeNormal();
-	}
-	else if (i == ChainPoints.Num() - 1)
+	const bool bBroken = BrokenLinkIndices.Num() > 0;
+
+	for (int32 i = 0; i < NumPoints; i++)
 	{
-		Direction = (p1.Position - ChainPoints[i - 1].Position).GetUnsafeNormal();
+		// The ends of a piece only look at their own piece.
+		const int32 PrevIndex = bBroken && i > 0 && BrokenLinks[i - 1] ? i : FMath::Max(i - 1, 0);
+		const int32 NextIndex = bBroken && BrokenLinks[i] ? i : FMath::Min(i + 1, NumPoints - 1);
+
+		// A single point left between two broken links keeps its orientation.
+		if (PrevIndex == NextIndex) continue;
+
+		const FVector& Prev = Positions[PrevIndex];
+		const FVector& Next = Positions[NextIndex];
+		const FVector Direction = (Next - Prev).GetUnsafeNormal();
+
+		FVector Forward = FVector::CrossProduct(Direction, FVector::ForwardVector);
+		FVector Right = FVector::CrossProduct(Direction, Forward);
+
+		Directions[i] = Right;
+		Rotations[i] = Right.ToOrientationRotator();
+		Rotations[i].Add(90 + AdditiveRotation.X * i, AdditiveRotation.Y * i, AdditiveRotation.Z * i);
 	}
-	else
+}
+
+USceneComponent* UChainComponent::ResolveAttachment(FChainAttachment& Cache, const FComponentReference& Reference, FName Socket) const
+{
+	if (Cache.NeedsResolve(Reference, Socket))
 	{
-		Direction = (ChainPoints[i + 1].Position - ChainPoints[i - 1].Position).GetUnsafeNormal();
+		Cache.Resolve(Reference, Socket, GetOwner());
 	}
 
-	FVector Forward = FVector::CrossProduct(Direction, FVector::ForwardVector);
-	FVector Right = FVector::CrossProduct(Direction, Forward);
-
-	p1.Direction = Right;
-	p1.Rotation = p1.Direction.ToOrientationRotator();
+	return Cache.GetComponent();
+}
 
-	p1.Rotation.Add(90 + AdditiveRotation.X * i, AdditiveRotation.Y * i, AdditiveRotation.Z * i);
+void UChainComponent::InvalidateAttachments()
+{
+	AttachStartCache.Invalidate();
+	AttachEndCache.Invalidate();
+	AttachComponentToStartCache.Invalidate();
+	AttachComponentToEndCache.Invalidate();
 }
 
 FVector UChainComponent::GetChainEndPoint() const
 {
-	if (AttachEndTo.OtherActor == nullptr)
+	USceneComponent* EndComponent = ResolveAttachment(AttachEndCache, AttachEndTo, AttachEndToSocket);
+
+	if (! AttachEndCache.IsReferenced())
 	{
 		return bIsLocal ? GetComponentLocation() + EndPoint : EndPoint;
 	}
 
-	USceneComponent* EndComponent = Cast<USceneComponent>(AttachEndTo.GetComponent(GetOwner()));
-
 	if (EndComponent)
 	{
-		return (AttachEndToSocket != NAME_None) ? EndComponent->GetSocketLocation(AttachEndToSocket) : (bIsLocal ? EndComponent->GetComponentTransform().TransformPosition(EndPoint) : EndComponent->GetComponentLocation());
+		return AttachEndCache.HasSocket() ? AttachEndCache.GetSocketLocation() : (bIsLocal ? EndComponent->GetComponentTransform().TransformPosition(EndPoint) : EndComponent->GetComponentLocation());
 	}
 
 	return FVector::ZeroVector;
 }
 
-void UChainComponent::CalculateChainPoint(bool bIsAttached, FComponentReference& AttachRef, FName AttachSocket, int32 PointIndex, bool bUseEndPoint)
+void UChainComponent::CalculateChainPoint(bool bIsAttached, const FComponentReference& AttachRef, FChainAttachment& AttachCache, FName AttachSocket, int32 PointIndex, bool bUseEndPoint)
 {
 	if (bIsAttached)
 	{
-		ChainPoints[PointIndex].bFree = false;
+		FreeFlags[PointIndex] = false;
+
+		USceneComponent* Component = ResolveAttachment(AttachCache, AttachRef, AttachSocket);
 
-		if (AttachRef.OtherActor == nullptr)
+		if (! AttachCache.IsReferenced())
 		{
-			ChainPoints[PointIndex].Position = bUseEndPoint ? (bIsLocal ? GetComponentLocation() + EndPoint : EndPoint) : GetComponentLocation();
+			Positions[PointIndex] = bUseEndPoint ? (bIsLocal ? GetComponentLocation() + EndPoint : EndPoint) : GetComponentLocation();
 		}
-		else
+		else if (Component)
 		{
-			USceneComponent* component = Cast<USceneComponent>(AttachRef.GetComponent(GetOwner()));
-			if (component)
-			{
-				ChainPoints[PointIndex].Position = (AttachSocket != NAME_None) ? component->GetSocketLocation(AttachSocket) : (bUseEndPoint && bIsLocal ? component->GetComponentTransform().TransformPosition(EndPoint) : component->GetComponentLocation());
-			}
+			Positions[PointIndex] = AttachCache.HasSocket() ? AttachCache.GetSocketLocation() : (bUseEndPoint && bIsLocal ? Component->GetComponentTransform().TransformPosition(EndPoint) : Component->GetComponentLocation());
 		}
 	}
 	else
 	{
-		ChainPoints[PointIndex].bFree = true;
+		FreeFlags[PointIndex] = true;
 	}
-}
\ No newline at end of file
+}
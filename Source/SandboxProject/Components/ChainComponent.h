@@ -8,14 +8,132 @@
 #include "Engine/EngineTypes.h"
 #include "Engine/Engine.h"
 #include "UObject/ObjectMacros.h"
+#include "WorldCollision.h"
+#include "Engine/OverlapResult.h"
+#include "ChainSolver.h"
+#include "ChainSpatialHash.h"
+#include "ChainAttachment.h"
+#include "ChainSnapshot.h"
+#include "ChainForceField.h"
+#include "ChainReplication.h"
 
 #include "ChainComponent.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnSoundReached, const FVector, Velocity);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnChainCollide, const TArray<FHitResult>, HitResult);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnChainCollide, const TArray<FHitResult>&, HitResult);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChainBroken, int32, LinkIndex, const FVector, Location);
 
 class UInstancedStaticMeshComponent;
 class UStaticMesh;
+class UChainSimulationSubsystem;
+struct FChainPhaseTimings;
+
+/**
+ *	Enum representing the solver used to integrate and constrain the chain points.
+ */
+UENUM(BlueprintType)
+enum class EChainSolverBackend : uint8
+{
+	/** Gauss-Seidel solver, projects one pair of points at a time */
+	Scalar UMETA(DisplayName = "Scalar"),
+
+	/** SIMD Jacobi solver, integrates and projects four points per instruction */
+	Vectorized UMETA(DisplayName = "Vectorized"),
+
+	/** Extended position based dynamics in chain order, segment stiffness set by Compliance */
+	XPBD UMETA(DisplayName = "XPBD"),
+
+	/** Extended position based dynamics in red-black order, long chains solve each color on several threads */
+	XPBDRedBlack UMETA(DisplayName = "XPBD Red-Black (parallel)"),
+};
+
+/**
+ *	Enum representing how the chain points query the world for collision.
+ */
+UENUM(BlueprintType)
+enum class EChainCollisionQueryMode : uint8
+{
+	/** Blocking sweeps on the game thread, results are applied in the same frame */
+	Synchronous UMETA(DisplayName = "Synchronous"),
+
+	/** Async sweeps overlapped with the rest of the frame, results are applied one frame later */
+	Async UMETA(DisplayName = "Async (one frame latency)"),
+};
+
+/**
+ *	Enum representing how the chain is drawn.
+ */
+UENUM(BlueprintType)
+enum class EChainRenderMode : uint8
+{
+	/** One instance of ChainMesh per point, through the instanced static mesh component */
+	Instances UMETA(DisplayName = "Instances"),
+
+	/** A tube through the points, generated by the scene proxy of the chain component */
+	Cable UMETA(DisplayName = "Cable"),
+};
+
+/**
+ * An async sweep issued for a chain point and waiting for its result.
+ */
+struct FChainPendingSweep
+{
+	/** Handle of the async trace. */
+	FTraceHandle Handle;
+
+	/** Index of the point the sweep was issued for. */
+	int32 PointIndex = INDEX_NONE;
+};
+
+/**
+ * Simulation settings of one chain level of detail, selected by the significance of the chain.
+ */
+USTRUCT(BlueprintType)
+struct FChainLODSettings
+{
+	GENERATED_BODY()
+
+	FChainLODSettings() = default;
+
+	FChainLODSettings(float InMaxDistance, int32 InTickInterval, int32 InMaxIterations, bool bInEnableCollision, int32 InSegmentStride)
+		: MaxDistance(InMaxDistance)
+		, TickInterval(InTickInterval)
+		, MaxIterations(InMaxIterations)
+		, bEnableCollision(bInEnableCollision)
+		, SegmentStride(InSegmentStride)
+	{
+	}
+
+	/**
+	 * Maximal distance between the chain and the closest viewpoint for this level of detail.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChainComponent", meta = (UIMin = 0.0))
+	float MaxDistance = 2000.0f;
+
+	/**
+	 * Number of frames between two simulation steps, multiplied with Skip. 0 freezes the chain.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChainComponent", meta = (UIMin = 0))
+	int32 TickInterval = 1;
+
+	/**
+	 * Upper bound of the constraint iterations, negative values keep the chain Stiffness.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChainComponent")
+	int32 MaxIterations = -1;
+
+	/**
+	 * Determines if world and self collision are resolved.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChainComponent")
+	bool bEnableCollision = true;
+
+	/**
+	 * Only every n-th point is simulated, the points in between are interpolated.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ChainComponent", meta = (UIMin = 1))
+	int32 SegmentStride = 1;
+};
 
 /**
  * Struct containing information about a point along the cable.
@@ -129,12 +247,24 @@ class SANDBOXPROJECT_API UChainComponent : public UMeshComponent
 {
 	GENERATED_BODY()
 
+	friend class UChainSimulationSubsystem;
+	friend class UChainPoolSubsystem;
+
 public:
 	UChainComponent(const FObjectInitializer& ObjectInitializer);
 	virtual void OnRegister() override;
 	virtual void OnUnregister() override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	virtual void BeginPlay() override;
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+	virtual int32 GetNumMaterials() const override;
+	virtual void GetUsedMaterials(TArray<UMaterialInterface*>& OutMaterials, bool bGetDebugMaterials = false) const override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 
 	/**
 	 * Applies a force to the chain at a specified position within a given radius.
@@ -147,6 +277,23 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ChainComponent|Chain Component")
 	TArray<int> ApplyForce(FVector InPosition, float InRadius, FVector InForce);
 
+	/**
+	 * Applies a force to every point of a segment that intersects the given sphere.
+	 * Chains whose bounds do not overlap the sphere are rejected without touching their points.
+	 *
+	 * @param InPosition The world position where the force will be applied.
+	 * @param InRadius The radius within which the force affects the chain segments.
+	 * @param InForce The vector representing the force to be applied.
+	 * @param OutAffectedPoints Receives the ascending indices of the affected points, its allocation is reused.
+	 * @return The number of affected points.
+	 */
+	int32 ApplyForce(const FVector& InPosition, float InRadius, const FVector& InForce, TArray<int32>& OutAffectedPoints);
+
+	/**
+	 * @return True if the bounds of the chain points overlap the given sphere.
+	 */
+	bool OverlapsSphere(const FVector& Center, float Radius) const;
+
 	/**
 	 * Retrieves the position of a specific point in the chain.
 	 *
@@ -176,295 +323,1488 @@ public:
 
 	/**
 	 * Gets the array of points that define the chain.
+	 * The point data is assembled from the simulation buffers on every call, prefer GetChainPositions natively
+	 * and the point, nearest point and bounds queries in Blueprint on hot paths.
 	 *
 	 * @return An array of FChainPointData containing information about each chain point.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "ChainComponent|Chain Component")
-	FORCEINLINE TArray<FChainPointData> GetChainPoints() { return ChainPoints; }
+	TArray<FChainPointData> GetChainPoints() const;
 
-protected:
 	/**
-	 * Initializes the chain's parameters and properties.
-	 * This function is called at the start to set up the chain.
+	 * Assembles the Blueprint facing data of a single chain point from the simulation buffers.
+	 *
+	 * @param PointIndex The index of the chain point.
+	 * @return The point data, or a default constructed point if the index is out of range.
 	 */
-	virtual void InitChain();
+	FChainPointData MakeChainPointData(int32 PointIndex) const;
 
 	/**
-	 * Draws debug visuals for the chain points in the editor.
-	 * This helps in visualizing the state and position of the chain during development.
+	 * @return The number of simulated chain points.
 	 */
-	void DrawChainPoints();
+	FORCEINLINE int32 GetNumChainPoints() const { return Positions.Num(); }
 
 	/**
-	 * Updates the attachment points for the start and end of the chain.
-	 * This ensures that the chain is correctly anchored to the specified components.
+	 * @return A view of the simulated world space position of every point, valid until the chain is re-initialized.
 	 */
-	void UpdateAttachments();
+	FORCEINLINE TConstArrayView<FVector> GetChainPositions() const { return Positions; }
 
 	/**
-	 * Calculates the positions of the points in the chain based on physics constraints.
-	 * This method determines the spatial configuration of the chain segments.
+	 * @return A view of the rotation of every point, valid until the chain is re-initialized.
 	 */
-	void CalculatePoints();
+	FORCEINLINE TConstArrayView<FRotator> GetChainRotations() const { return Rotations; }
 
 	/**
-	 * Applies gravity to the chain segments to simulate realistic falling behavior.
-	 * This method updates the positions of the chain points based on gravitational forces.
+	 * @return A view of the velocity of every point, valid until the chain is re-initialized.
 	 */
-	void ApplyGravity();
+	FORCEINLINE TConstArrayView<FVector> GetChainVelocities() const { return Velocities; }
 
 	/**
-	 * Solves the distance constraints between the points in the chain.
-	 * This ensures that the segments maintain their defined lengths.
+	 * Finds the point at a fraction of the current length of the chain, measured along its segments.
+	 *
+	 * @param NormalizedDistance 0 for the start of the chain, 1 for its end.
+	 * @return The world space location on the chain.
 	 */
-	void SolveConstraint();
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FVector GetPointAtNormalizedDistance(float NormalizedDistance) const;
 
 	/**
-	 * Resolves any collisions that occur between chain segments or with other objects.
-	 * This method checks for overlapping points and adjusts their positions accordingly.
+	 * Finds the location on the chain segments closest to a world location.
+	 *
+	 * @param Location The world location to query.
+	 * @param SegmentIndex The index of the first point of the closest segment.
+	 * @param NormalizedDistance The fraction of the chain length at the closest location.
+	 * @return The closest world space location on the chain.
 	 */
-	void ResolveCollision();
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FVector FindNearestPoint(FVector Location, int32& SegmentIndex, float& NormalizedDistance) const;
 
 	/**
-	 * Updates the instanced mesh component to reflect the current state of the chain.
-	 * This method refreshes the visual representation of the chain based on the calculated points.
+	 * @return The world space bounding box of the chain points.
 	 */
-	void UpdateMeshes();
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FBox GetChainBounds() const;
+
+	/**
+	 * @return The current length of the chain, measured along its segments.
+	 */
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	float GetCurrentChainLength() const;
+
+	/**
+	 * Wakes the chain up if it is sleeping, the chain is simulated again from the next step.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ChainComponent|Chain Component")
+	void WakeChain();
+
+	/**
+	 * @return True if the chain is at rest and not simulated.
+	 */
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FORCEINLINE bool IsChainSleeping() const { return bSleeping; }
 
 	/**
-	 * Updates the position of a specific point in the chain based on its neighbors and length constraints.
+	 * Parks the chain in a pool or takes it out again. A pooled chain stays registered with its buffers
+	 * and instances allocated, but is hidden and neither simulated nor evaluated for significance.
 	 *
-	 * @param i The index of the point to update.
-	 * @param p1 The first neighboring point.
-	 * @param p2 The second neighboring point.
-	 * @param length The desired length between the points.
-	 * @param offset An integer offset for additional adjustments.
+	 * @param bInPooled Whether the chain is parked.
 	 */
-	void UpdatePoint(size_t i, FChainPointData& p1, FChainPointData& p2, float length, int offset);
+	void SetChainPooled(bool bInPooled);
 
 	/**
-	 * The starting point of the chain in the world space.
+	 * @return True if the chain is parked in a pool.
 	 */
-	FVector ChainStart, ChainEnd;
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FORCEINLINE bool IsChainPooled() const { return bPooled; }
 
 	/**
-	 * A frame counter used to skip certain calculations for performance optimization.
+	 * Breaks the link between a point and the next one, splitting the chain into independently simulated pieces.
+	 * The pieces keep their points and instances in place, nothing is reallocated.
+	 *
+	 * @param LinkIndex The index of the first point of the link.
+	 * @return True if the link was intact and is now broken.
 	 */
-	int Frame = 0;
+	UFUNCTION(BlueprintCallable, Category = "ChainComponent|Chain Component")
+	bool BreakLink(int32 LinkIndex);
 
 	/**
-	 * The length of each segment in the chain.
+	 * @param LinkIndex The index of the first point of the link.
+	 * @return True if the link between the point and the next one is broken.
 	 */
-	float SegmentLength;
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	bool IsLinkBroken(int32 LinkIndex) const;
 
 	/**
-	 * An array holding the data for each point in the chain.
+	 * @return The number of pieces the chain is broken into, 1 for an intact chain.
 	 */
-	TArray<FChainPointData> ChainPoints;
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FORCEINLINE int32 GetNumChainPieces() const { return BrokenLinkIndices.Num() + 1; }
 
-	//---data---
-public:
 	/**
-	 * The interpolation factor used for chain movement.
+	 * Returns the range of points of one piece of a broken chain.
+	 *
+	 * @param PieceIndex The index of the piece, from the start of the chain.
+	 * @param FirstPoint Receives the first point of the piece.
+	 * @param LastPoint Receives the last point of the piece.
 	 */
-	UPROPERTY(EditAnywhere, Category = "ChainComponent|Chain Component")
-	float Lerp = 0.1;
+	UFUNCTION(BlueprintCallable, Category = "ChainComponent|Chain Component")
+	void GetChainPiece(int32 PieceIndex, int32& FirstPoint, int32& LastPoint) const;
 
 	/**
-	 * Delegate called when the chain reaches a sound threshold.
+	 * @return The first point of every broken link, ascending.
 	 */
-	UPROPERTY(BlueprintAssignable, Category = "ChainComponent|Chain Component")
-	FOnSoundReached OnSoundReached;
+	FORCEINLINE TConstArrayView<int32> GetBrokenLinkIndices() const { return BrokenLinkIndices; }
 
 	/**
-	 * Delegate called when the chain collides with an object.
+	 * @return The index of the active entry of LODSettings, or INDEX_NONE if the chain is offscreen.
 	 */
-	UPROPERTY(BlueprintAssignable, Category = "ChainComponent|Chain Component")
-	FOnChainCollide OnCollide;
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FORCEINLINE int32 GetChainLOD() const { return CurrentLOD; }
 
 	/**
-	 * Reference to the static mesh used for the chain.
+	 * @return The constraint iterations run in the last step, summed over its substeps.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Chains static mesh reference"))
-	UStaticMesh* ChainMesh;
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FORCEINLINE int32 GetLastSolverIterations() const { return LastSolverIterations; }
 
 	/**
-	 * Scale transform applied to each chain segment.
+	 * @return The largest relative stretch of a segment after the last step.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Transform scale of each chain"))
-	FVector Scale = FVector::OneVector;
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FORCEINLINE float GetLastSolverResidual() const { return LastSolverResidual; }
 
 	/**
-	 * Number of segments in the chain.
+	 * @return The component space position of each point as last sent to the scene proxy, empty unless RenderMode is Cable.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Number of chain segments"))
-	int Segments = 10;
+	FORCEINLINE TConstArrayView<FVector3f> GetPackedRenderPoints() const { return PackedRenderPoints; }
 
 	/**
-	 * Incremental rotation applied to each chain segment.
+	 * @return The number of simulation steps since the chain was initialized, counting every substep.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Incremental Transform rotation of each chain"))
-	FVector AdditiveRotation = FVector(0, 0, 45);
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FORCEINLINE int64 GetSimulationStep() const { return SimulationStep; }
 
 	/**
-	 * The rest length of the chain segments.
+	 * Stores the current simulation state in the snapshot ring buffer. Does nothing if SnapshotCapacity is 0.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Rest length of chains"))
-	float ChainLength = 1.5f;
+	UFUNCTION(BlueprintCallable, Category = "ChainComponent|Chain Component")
+	void CaptureSnapshot();
 
 	/**
-	 * Determines if the chain uses local space for its transformations.
+	 * Rewinds the chain, including its broken links, to the newest snapshot captured at or before the step.
+	 * Snapshots after it are dropped, stepping on replays the chain deterministically from the snapshot.
+	 *
+	 * @param Step The simulation step to rewind to.
+	 * @return True if a snapshot was found and restored.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", meta = (ShortToolTip = "Is Local space", MakeEditWidget = true))
-	bool bIsLocal = true;
+	UFUNCTION(BlueprintCallable, Category = "ChainComponent|Chain Component")
+	bool RestoreSnapshot(int64 Step);
 
 	/**
-	 * The endpoint location of the chain.
+	 * @return The number of snapshots currently held.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", meta = (ShortToolTip = "Location of the end point", MakeEditWidget = true))
-	FVector EndPoint = FVector(100, 0, 0);
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	FORCEINLINE int32 GetNumSnapshots() const { return Snapshots.Num(); }
 
 	/**
-	 * Determines if the chain is attached at the start point.
+	 * @return The material of the cable: the first material override, or the first material of ChainMesh.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", meta = (ShortToolTip = "Is attached to start point"))
-	bool AttachStart = true;
+	UMaterialInterface* GetCableMaterial() const;
 
 	/**
-	 * Reference to the component to attach the start point to.
+	 * Sets the sink the cycles of each step phase are added to, null stops the measurement.
+	 * Used by the chain benchmark, the sink must outlive the measurement.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "Start point attachment component reference"))
-	FComponentReference AttachStartTo;
+	FORCEINLINE void SetPhaseTimings(FChainPhaseTimings* InPhaseTimings) { PhaseTimings = InPhaseTimings; }
 
 	/**
-	 * The socket name for the start point attachment.
+	 * Runs one frame of the chain on the calling thread, the way the component tick does: simulation, events and render update.
+	 * For callers that drive chains themselves, e.g. benchmarks and tests. Chains batched by the subsystem must not be stepped here.
+	 *
+	 * @param DeltaTime Time elapsed since the last frame.
+	 * @return True if the chain simulated this frame.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "Start point attachment socket name"))
-	FName AttachStartToSocket;
+	bool StepChain(float DeltaTime);
 
 	/**
-	 * Determines if the chain is attached at the end point.
+	 * Simulates the chain from a straight line until it is at rest and stores the settled pose in the component.
+	 * The chain then starts from the stored pose, asleep, instead of settling after every load.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "Is attached to end point"))
-	bool AttachEnd = true;
+	UFUNCTION(CallInEditor, Category = "ChainComponent|ChainRestPose")
+	void BakeRestPose();
 
 	/**
-	 * Reference to the component to attach the end point to.
+	 * Removes the baked rest pose, the chain starts from a straight line again.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "End point attachment component reference"))
-	FComponentReference AttachEndTo;
+	UFUNCTION(CallInEditor, Category = "ChainComponent|ChainRestPose")
+	void ClearRestPose();
 
 	/**
-	 * The socket name for the end point attachment.
+	 * @return True if a rest pose was baked for the current chain settings and is used.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "End point attachment socket name"))
-	FName AttachEndToSocket;
+	UFUNCTION(BlueprintPure, Category = "ChainComponent|Chain Component")
+	bool HasValidRestPose() const;
 
+protected:
 	/**
-	 * Reference to the component for attaching to the start point.
+	 * Initializes the chain's parameters and properties.
+	 * This function is called at the start to set up the chain.
 	 */
-	UPROPERTY(EditAnyWhere, Category = "ChainComponent|ChainAttachment", meta = (ShortToolTip = "Start point attachment component reference"))
-	FComponentReference AttachComponentToStart;
+	virtual void InitChain();
 
 	/**
-	 * Determines if the start attachment component should be rotated.
+	 * Resets the state derived from the chain points after InitChain placed them.
+	 * Wakes the chain, drops uploaded instances and pending sweeps and restarts the substep interpolation.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttachment", meta = (ShortToolTip = "Rotate start attachment component"))
-	bool RotateStartAttachment = true;
+	void ResetSimulationState();
 
 	/**
-	 * Reference to the component for attaching to the end point.
+	 * Sends the packed render points to the scene proxy on the render thread.
 	 */
-	UPROPERTY(EditAnyWhere, Category = "ChainComponent|ChainAttachment", meta = (ShortToolTip = "Start point attachment component reference"))
-	FComponentReference AttachComponentToEnd;
+	virtual void SendRenderDynamicData_Concurrent() override;
 
 	/**
-	 * Determines if the end attachment component should be rotated.
+	 * Packs the render positions into component space for the scene proxy and updates the bounds.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttachment", meta = (ShortToolTip = "Rotate start attachment component"))
-	bool bRotateEndAttachment = true;
+	void PackRenderPoints();
 
 	/**
-	 * The gravity scale applied to the chains.
+	 * Keeps the tick of batched and pooled chains disabled. Registering the tick functions enables them again
+	 * because of bStartWithTickEnabled, which happens after OnRegister registered the chain with the subsystem.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (ShortToolTip = "Gravity scale of chains"))
-	float Gravity = 0.98f;
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
 
 	/**
-	 * The stiffness of the chains.
+	 * Adds the instances of the chain points in a single call.
+	 *
+	 * @param NumInstances The number of instances to add.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 1.0, ShortToolTip = "Stiffness of chains"))
-	int Stiffness = 10;
+	void AddChainInstances(int32 NumInstances);
 
 	/**
-	 * The friction coefficient of the chains.
+	 * Makes the instanced mesh hold one instance per chain point. Existing instance slots are kept
+	 * when their count already matches, so reinitializing a chain does not rebuild the instance buffer.
+	 *
+	 * @param NumInstances The number of instances the chain needs.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 0.1, UIMax = 1.0, ShortToolTip = "Friction of chains"))
-	float Friction = 0.3f;
+	void SyncChainInstances(int32 NumInstances);
 
 	/**
-	 * The width of the chain for world collision detection.
+	 * Moves the chain points to the baked rest pose and puts the chain to sleep, if the pose is valid
+	 * and the pins are as far apart, horizontally and vertically, as when the pose was baked.
+	 *
+	 * @return True if the rest pose was applied.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Chains width for world collision detection"))
-	float ChainWidth = 20;
+	bool ApplyRestPose();
 
 	/**
-	 * Determines if self-collision is enabled for the chains.
+	 * Moves the pins to the attachments and computes the frame the rest pose is stored in.
+	 * The frame starts at the first point and faces the last one on the horizontal plane, so the pose
+	 * follows the pins when the actor moves or turns around the vertical axis, while gravity keeps pointing down.
+	 *
+	 * @param OutSpan Receives the offset from the first to the last point in the frame.
+	 * @return The world space frame of the rest pose.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (UIMin = 0.0, UIMax = 1.0, ShortToolTip = "Is self collision enabled"))
-	bool bSelfCollision = false;
+	FTransform CalculateRestPoseFrame(FVector& OutSpan);
 
 	/**
-	 * The width for self-collision detection of the chains.
+	 * @return A hash of the settings the rest pose depends on, every setting the bake simulation reads. A baked pose with another hash is ignored.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Chains width for self collision detection"))
-	float SelfCollisionWidth = 20;
+	virtual uint32 GetRestPoseHash() const;
 
 	/**
-	 * The threshold for self-collision detection of the chain.
-	 * If the force exceeds this value, self-collision will be triggered.
+	 * Draws debug visuals for the chain points in the editor.
+	 * This helps in visualizing the state and position of the chain during development.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Self collision force threshold"))
-	float SelfCollisionThreshold = 0.05f;
+	void DrawChainPoints();
 
 	/**
-	 * The number of frames to skip when rendering the chain.
-	 * This allows for optimization by reducing the update frequency.
-	 * Default value is 0.
+	 * Updates the attachment points for the start and end of the chain.
+	 * This ensures that the chain is correctly anchored to the specified components.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (UIMin = 0.0, ShortToolTip = "Chains skip counter by frame"))
-	int Skip = 0;
+	void UpdateAttachments();
 
 	/**
-	 * Determines if debug visualization for the chains is enabled.
-	 * If true, debug drawings will be displayed in the editor.
-	 * Default value is false.
+	 * Returns the component of an attachment reference, resolving the cache first if it is stale.
+	 *
+	 * @param Cache The cache of the reference.
+	 * @param Reference The component reference.
+	 * @param Socket The socket on the referenced component.
+	 * @return The referenced component, or null if it does not exist.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (ShortToolTip = "Is chains debug drawer enabled"))
-	bool bDrawDebugger = false;
+	USceneComponent* ResolveAttachment(FChainAttachment& Cache, const FComponentReference& Reference, FName Socket) const;
 
 	/**
-	 * Reference to the instanced static mesh component used for the chain.
-	 * This component handles the instancing of the chain meshes for better performance.
+	 * Resolves every attachment reference again on its next use.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (UIMin = 0.0, ShortToolTip = "Instanced component object reference"))
-	UInstancedStaticMeshComponent* InstanceComponent;
+	void InvalidateAttachments();
 
 	/**
-	 * The velocity threshold for triggering the OnSoundReached event.
-	 * When the chain's velocity exceeds this value, the event will be called.
-	 * Default value is 1.
+	 * Puts the chain to sleep once its kinetic energy stayed below SleepEnergyThreshold for SleepFrames steps.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainSound", meta = (UIMin = 0.0, ShortToolTip = "Chains velocity threshold for OnSoundReach event call"))
-	float SoundThreshold = 1;
+	void UpdateSleepState();
 
 	/**
-	 * The number of frames to skip before calling the OnSoundReached event.
-	 * This helps in controlling the frequency of the event calls.
-	 * Default value is 1.
+	 * Checks if a moving dynamic object overlaps the bounds of the sleeping chain.
+	 * Objects at rest, e.g. an idle pawn next to the chain, do not wake it up.
+	 *
+	 * @return True if the chain should wake up.
 	 */
-	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainSound", meta = (UIMin = 0.0, ShortToolTip = "Skip counter by frame for calling OnSoundReach event call"))
-	int SoundSkip = 1;
+	bool ProbeForWake();
+
+	/**
+	 * Registers the chain with the significance manager of its world, if there is one.
+	 */
+	void RegisterSignificance();
+
+	/**
+	 * Removes the chain from the significance manager.
+	 */
+	void UnregisterSignificance();
+
+	/**
+	 * Significance of the chain for one viewpoint, evaluated by the significance manager.
+	 *
+	 * @param Viewpoint The transform of the viewpoint.
+	 * @return 0 if the chain was not rendered recently, otherwise the number of LODSettings entries minus the matching entry index.
+	 */
+	float CalculateSignificance(const FTransform& Viewpoint) const;
+
+	/**
+	 * @return True if the chain was rendered within OffscreenDelay, always true if nothing can render, e.g. with -nullrhi.
+	 */
+	bool WasChainRecentlyRendered() const;
+
+	/**
+	 * Selects the level of detail matching the significance computed by the significance manager.
+	 *
+	 * @param Significance The highest significance over all viewpoints.
+	 */
+	void SetSignificance(float Significance);
+
+	/**
+	 * @return The settings of the active level of detail, the more detailed one of the local and the remote viewers.
+	 */
+	const FChainLODSettings& GetActiveLODSettings() const;
+
+	/**
+	 * @param DistanceSquared The squared distance between a viewpoint and the chain.
+	 * @return The index of the LODSettings entry covering the distance, the last entry beyond all of them.
+	 */
+	int32 GetLODForDistance(double DistanceSquared) const;
+
+	/**
+	 * Selects NetLOD from the closest remote connection the owner is net relevant for, every ReplicationInterval.
+	 * Only authoritative replicated chains on a server have remote viewers.
+	 */
+	void UpdateNetLOD();
+
+	/**
+	 * @return The number of constraint iterations after the first pass, limited by the active level of detail.
+	 */
+	int32 GetSolverIterations() const;
+
+	/**
+	 * @return The number of frames between two steps at the active level of detail, 0 or less if the chain is frozen.
+	 */
+	int32 GetStepInterval() const;
+
+	/**
+	 * Rebuilds the indices of the simulated points for the given stride.
+	 * The first and the last point, and both points of every broken link, are always simulated.
+	 *
+	 * @param Stride Distance between two simulated points.
+	 */
+	void RebuildSimulatedIndices(int32 Stride);
+
+	/**
+	 * Places the free points skipped by the stride on the line between their simulated neighbours.
+	 * Forces accumulated on skipped points are handed over to the closest simulated point.
+	 */
+	void InterpolateSkippedPoints();
+
+	/**
+	 * Breaks the most stretched link if its stretch exceeds BreakStretch. At most one link breaks per step,
+	 * the tension of the rest of the chain drops with it.
+	 */
+	void DetectBreaks();
+
+	/**
+	 * Marks a link as broken and queues its OnChainBroken event. Safe to call from the simulation step.
+	 * The link has to exist, links that are already broken are left as they are.
+	 */
+	void MarkLinkBroken(int32 LinkIndex);
+
+	/**
+	 * @return True if this is the server of a networked game and the chain replicates its state.
+	 */
+	bool IsReplicationAuthority() const;
+
+	/**
+	 * @return True if this is a client receiving the replicated state of the chain.
+	 */
+	bool IsReplicationClient() const;
+
+	/**
+	 * Writes the most diverged keyframe points into the replicated keyframes, at most ReplicationMaxKeyframes
+	 * per update. Updates are spaced by ReplicationInterval, stretched by NetLOD, the level of detail of the
+	 * closest remote viewer, so the view of the host does not throttle what the clients see.
+	 *
+	 * @param bForce Whether to update regardless of the interval, e.g. before the chain falls asleep.
+	 */
+	void UpdateReplicatedKeyframes(bool bForce);
+
+	/**
+	 * Pulls the keyframe points toward their replicated locations, moving the previous positions along
+	 * so the correction does not add velocity.
+	 *
+	 * @return True if any keyframe was still pending.
+	 */
+	bool ApplyReplicatedKeyframes();
+
+	/**
+	 * Breaks the links the server reported as broken.
+	 */
+	UFUNCTION()
+	void OnRep_BrokenLinks();
+
+	/**
+	 * First simulation phase, runs on the game thread.
+	 * Advances the frame counter, pins the attached points and caches everything the solver reads from the world.
+	 *
+	 * @param DeltaTime Time elapsed since the last frame.
+	 * @return True if the chain steps this frame.
+	 */
+	virtual bool PreSimulate(float DeltaTime);
+
+	/**
+	 * Second simulation phase, integrates gravity and solves the constraints.
+	 * Only touches the chain's own buffers, so it is safe to run on a worker thread.
+	 */
+	void Simulate();
+
+	/**
+	 * Last simulation phase, runs on the game thread.
+	 * Resolves world collision, updates the sleep state and broadcasts delegates.
+	 */
+	void PostSimulate();
+
+	/**
+	 * Runs every frame on the game thread, after PostSimulate if the chain stepped.
+	 * Updates the instances and attached components if the chain stepped or its interpolated state changed.
+	 */
+	void UpdateRender();
+
+	/**
+	 * Moves the pins of a chain frozen by its level of detail to the attachments.
+	 * The render is only updated once a pin moved farther than SleepAttachmentTolerance from its rendered location.
+	 */
+	void UpdateFrozenPins();
+
+	/**
+	 * Takes as many fixed substeps out of the time accumulator as fit, up to MaxSubsteps.
+	 *
+	 * @return The number of substeps to simulate this step.
+	 */
+	int32 ConsumeSubsteps();
+
+	/**
+	 * @return True if the rendered positions are interpolated between the last two substeps.
+	 */
+	FORCEINLINE bool ShouldInterpolate() const { return bInterpolateSubsteps && SubstepRate > 0.0f; }
+
+	/**
+	 * @return The positions the instances and attached components are placed at.
+	 */
+	FORCEINLINE const TArray<FVector>& GetRenderPositions() const { return ShouldInterpolate() ? RenderPositions : Positions; }
+
+	/**
+	 * Applies gravity to the chain segments to simulate realistic falling behavior.
+	 * This method updates the positions of the chain points based on gravitational forces.
+	 */
+	void ApplyGravity();
+
+	/**
+	 * Collects the force fields and impulses of the simulation subsystem that reach the chain.
+	 *
+	 * @return True if any field or impulse reaches the chain.
+	 */
+	bool GatherForceFields();
+
+	/**
+	 * Adds the displacement of the gathered force fields to the free simulated points for one step.
+	 *
+	 * @param bApplyImpulses Whether the pending impulses are applied and consumed in this step.
+	 */
+	void ApplyForceFields(bool bApplyImpulses);
+
+	/**
+	 * Solves the distance constraints between the points in the chain.
+	 * This ensures that the segments maintain their defined lengths.
+	 */
+	void SolveConstraint();
+
+	/**
+	 * Runs gravity and the distance constraints through the vectorized solver backend.
+	 * Replaces ApplyGravity and SolveConstraint when SolverBackend is Vectorized.
+	 */
+	void SolveVectorized();
+
+	/**
+	 * Runs gravity and the distance constraints through the XPBD solver.
+	 * Replaces ApplyGravity and SolveConstraint when SolverBackend is XPBD or XPBDRedBlack.
+	 */
+	void SolveXPBD();
+
+	/**
+	 * Moves the free simulated points by their accumulated forces and clears them.
+	 */
+	void ApplyExternalForces();
+
+	/**
+	 * @return True if every point has a follow target and a follow stiffness.
+	 */
+	FORCEINLINE bool HasFollowTargets() const { return FollowTargets.Num() == Positions.Num() && FollowStiffness.Num() == Positions.Num(); }
+
+	/**
+	 * Converts FollowStiffness of the simulated points into the fraction closed per solver iteration.
+	 *
+	 * @param Iterations The number of solver iterations of one step.
+	 */
+	void UpdateFollowIterationStiffness(int32 Iterations);
+
+	/**
+	 * @return The displacement gravity applies to a free point in one substep.
+	 */
+	FVector GetGravityStep() const;
+
+	/**
+	 * @return The simulation subsystem of the component's world, if the chain should be simulated by it.
+	 */
+	UChainSimulationSubsystem* GetSimulationSubsystem() const;
+
+	/**
+	 * Resolves any collisions that occur between chain segments or with other objects.
+	 * This method checks for overlapping points and adjusts their positions accordingly.
+	 */
+	void ResolveCollision();
+
+	/**
+	 * Pushes apart points of the chain that are closer than SelfCollisionWidth.
+	 * Uses the spatial hash broadphase unless bSelfCollisionBroadphase is disabled.
+	 */
+	void ResolveSelfCollision();
+
+	/**
+	 * Pushes the free points of the chain away from the points of other chains in the shared collision world.
+	 * The displacement is accumulated into the forces and applied by the next step.
+	 *
+	 * @param World The collision world of the simulation subsystem, built after the chains stepped.
+	 * @param ChainIndex The index of this chain in the world.
+	 * @param Budget Maximal number of candidate pairs tested.
+	 * @return The number of candidate pairs tested.
+	 */
+	int32 ResolveChainCollision(const FChainCollisionWorld& World, int32 ChainIndex, int32 Budget);
+
+	/**
+	 * Sweeps every free point along its velocity with blocking scene queries.
+	 */
+	void SweepPointsSynchronous();
+
+	/**
+	 * Sweeps a single point along its velocity with a blocking scene query and applies the hits.
+	 *
+	 * @param PointIndex The index of the point to sweep.
+	 */
+	void SweepPoint(int32 PointIndex);
+
+	/**
+	 * Applies the results of the async sweeps issued in the previous step.
+	 * Points whose result is not available anymore fall back to a blocking sweep, as do all points after RestoreSnapshot.
+	 */
+	void ConsumeAsyncSweeps();
+
+	/**
+	 * Issues an async sweep for every free point, consumed by the next step.
+	 */
+	void SubmitAsyncSweeps();
+
+	/**
+	 * Moves a point out of the geometry it hit and removes the velocity along the hit normals.
+	 *
+	 * @param PointIndex The index of the point that hit the world.
+	 * @param Hits The hits of the point sweep.
+	 * @param bDeferred True if the hits were found for the position of the previous step.
+	 */
+	void ApplyCollisionHits(int32 PointIndex, const TArray<FHitResult>& Hits, bool bDeferred);
+
+	/**
+	 * Merges a hit into the pending contacts, keeping the most recent hit of each hit component.
+	 *
+	 * @param Hit The hit of a chain point.
+	 */
+	void AddContact(const FHitResult& Hit);
+
+	/**
+	 * @return True if a collide or sound event is waiting to be broadcast.
+	 */
+	FORCEINLINE bool HasPendingEvents() const { return PendingContacts.Num() > 0 || bSoundPending || PendingBrokenLinks.Num() > 0; }
+
+	/**
+	 * Broadcasts the pending collide and sound events whose interval has elapsed.
+	 *
+	 * @return The number of broadcast events.
+	 */
+	int32 DispatchEvents();
+
+	/**
+	 * Updates the instanced mesh component to reflect the current state of the chain.
+	 * Only instances that moved more than InstanceUpdateTolerance are uploaded, in contiguous batches,
+	 * and the render state is marked dirty once per chain.
+	 */
+	void UpdateMeshes();
+
+	/**
+	 * Uploads one contiguous run of instance transforms.
+	 *
+	 * @param StartIndex Index of the first instance of the run.
+	 * @param RunTransforms Transforms of the run, reset after the upload.
+	 */
+	void FlushInstanceRun(int32 StartIndex, TArray<FTransform>& RunTransforms);
+
+	/**
+	 * Projects a pair of points onto the segment length constraint and consumes their accumulated forces.
+	 *
+	 * @param A The index of the first point of the pair.
+	 * @param B The index of the second point of the pair.
+	 * @param Length The desired length between the points.
+	 */
+	void UpdatePoint(int32 A, int32 B, float Length);
+
+	/**
+	 * Recomputes the direction and rotation of every point from the solved positions.
+	 * Runs once per simulation step instead of once per constraint iteration.
+	 */
+	void UpdateOrientations();
+
+	/**
+	 * Rebuilds the cumulative segment lengths and the bounds if the chain moved since the last query.
+	 */
+	void UpdateQueryCache() const;
+
+	/**
+	 * Marks the query cache stale after the positions changed.
+	 */
+	FORCEINLINE void InvalidateQueryCache() { bQueryCacheDirty = true; }
+
+	/**
+	 * Resizes every per point simulation buffer to the given number of points.
+	 *
+	 * @param NumPoints The number of points the chain consists of.
+	 */
+	void ResizeChainBuffers(int32 NumPoints);
+
+	/**
+	 * The starting point of the chain in the world space.
+	 */
+	FVector ChainStart, ChainEnd;
+
+	/**
+	 * A frame counter used to skip certain calculations for performance optimization.
+	 * Only schedules work, the simulation itself is keyed by SimulationStep.
+	 */
+	uint32 Frame = 0;
+
+	/**
+	 * Simulation steps since InitChain, every substep counts.
+	 */
+	int64 SimulationStep = 0;
+
+	/**
+	 * Simulation step of the newest automatic snapshot.
+	 */
+	int64 LastSnapshotStep = INDEX_NONE;
+
+	/**
+	 * Snapshots of the recent simulation state, sized by SnapshotCapacity.
+	 */
+	FChainSnapshotBuffer Snapshots;
+
+	/**
+	 * Gravity displacement of the current step, cached on the game thread before simulating.
+	 */
+	FVector GravityStep = FVector::ZeroVector;
+
+	/**
+	 * Continuous force fields overlapping the chain, gathered on the game thread before simulating.
+	 */
+	TArray<FChainForceField> ForceFields;
+
+	/**
+	 * Impulses overlapping the chain that were not applied yet.
+	 */
+	TArray<FChainForceField> PendingImpulses;
+
+	/**
+	 * World time the force fields are sampled at in the current step.
+	 */
+	float ForceFieldTime = 0.0f;
+
+	/**
+	 * Serial of the newest impulse already gathered from the subsystem.
+	 */
+	uint32 AppliedImpulseSerial = 0;
+
+	/**
+	 * Whether the chain is currently stepped by the simulation subsystem instead of its own tick.
+	 */
+	bool bRegisteredWithSubsystem = false;
+
+	/**
+	 * Whether the chain is at rest and skips simulation until a wake event.
+	 */
+	bool bSleeping = false;
+
+	/**
+	 * Number of consecutive steps the chain stayed below the sleep energy threshold.
+	 */
+	int32 RestingSteps = 0;
+
+	/**
+	 * Bounds of the chain when it fell asleep, expanded by the chain width, used by the wake probe.
+	 */
+	FBox SleepBounds = FBox(ForceInit);
+
+	/**
+	 * Simulated time not consumed by a substep yet.
+	 */
+	float TimeAccumulator = 0.0f;
+
+	/**
+	 * Number of substeps of the current step, computed on the game thread before simulating.
+	 */
+	int32 NumSubsteps = 0;
+
+	/**
+	 * Whether the instances have to be updated by UpdateRender this frame.
+	 */
+	bool bRenderDirty = false;
+
+	/**
+	 * Start and end point of the chain when UpdateRender last ran, frozen chains only update their render when their pins move away from them.
+	 */
+	FVector RenderedStart = FVector::ZeroVector;
+	FVector RenderedEnd = FVector::ZeroVector;
+
+	/**
+	 * Constraint iterations of the last step, summed over its substeps.
+	 */
+	int32 LastSolverIterations = 0;
+
+	/**
+	 * Largest relative stretch of a segment after the last step.
+	 */
+	float LastSolverResidual = 0.0f;
+
+	/**
+	 * Index of the active entry of LODSettings, INDEX_NONE while the chain is offscreen.
+	 */
+	int32 CurrentLOD = 0;
+
+	/**
+	 * Whether the chain is registered with the significance manager.
+	 */
+	bool bRegisteredWithSignificance = false;
+
+	/**
+	 * Whether the chain is parked in a pool.
+	 */
+	bool bPooled = false;
+
+	/**
+	 * Stride the simulated indices were built for.
+	 */
+	int32 SimulatedStride = 1;
+
+	/**
+	 * Ascending indices of the points stepped by the solver, every point unless the level of detail skips some.
+	 */
+	TArray<int32> SimulatedIndices;
+
+	/**
+	 * Whether the link between each point and the next one is broken.
+	 */
+	TArray<bool> BrokenLinks;
+
+	/**
+	 * The first point of every broken link, ascending.
+	 */
+	TArray<int32> BrokenLinkIndices;
+
+	/**
+	 * Whether the constraint between each pair of consecutive simulated points is broken, empty while no link is.
+	 */
+	TArray<bool> BrokenConstraints;
+
+	/**
+	 * Links broken since the last OnChainBroken events.
+	 */
+	TArray<int32> PendingBrokenLinks;
+
+	/**
+	 * Authoritative locations of the keyframe points, delta replicated.
+	 */
+	UPROPERTY(Replicated, Transient)
+	FChainKeyframeArray ReplicatedKeyframes;
+
+	/**
+	 * Authoritative broken links, ascending.
+	 */
+	UPROPERTY(ReplicatedUsing = OnRep_BrokenLinks, Transient)
+	TArray<int32> ReplicatedBrokenLinks;
+
+	/**
+	 * World time of the last keyframe update on the server.
+	 */
+	double LastReplicationTime = -UE_BIG_NUMBER;
+
+	/**
+	 * Index of the LODSettings entry of the closest remote connection the owner is relevant for, INDEX_NONE without one.
+	 * Keeps authoritative chains simulated for the clients while the host does not see them.
+	 */
+	int32 NetLOD = INDEX_NONE;
+
+	/**
+	 * World time NetLOD was last selected at.
+	 */
+	double LastNetLODTime = -UE_BIG_NUMBER;
+
+	/**
+	 * Scratch buffer of the squared error and the item of each diverged keyframe, reused between updates.
+	 */
+	TArray<TPair<double, int32>> KeyframeErrors;
+
+	/**
+	 * The length of each segment in the chain.
+	 */
+	float SegmentLength;
+
+	/**
+	 * Simulation state, stored as structure of arrays.
+	 * The Verlet step only touches the hot buffers, so they are kept tightly packed and separate
+	 * from the data that is only needed for rendering and Blueprint queries.
+	 * Every buffer has exactly GetNumChainPoints() elements.
+	 */
+
+	/** Current world space position of each point. */
+	TArray<FVector> Positions;
+
+	/** Position of each point in the previous simulation step. */
+	TArray<FVector> OldPositions;
+
+	/** External force accumulated on each point, consumed by the constraint solver. */
+	TArray<FVector> Forces;
+
+	/** Whether each point is free (simulating) or pinned to an attachment. */
+	TArray<bool> FreeFlags;
+
+	/** Velocity of each point during the last gravity integration. */
+	TArray<FVector> Velocities;
+
+	/** Direction of each point, derived from its neighbours after solving. */
+	TArray<FVector> Directions;
+
+	/** Rotation of each point, derived from its direction after solving. */
+	TArray<FRotator> Rotations;
+
+	/** Normalized time of each point along the chain, used for spline interpolation. */
+	TArray<float> PointTimes;
+
+	/** Position of each point before the last substep, the start of the render interpolation. */
+	TArray<FVector> PreviousPositions;
+
+	/** Interpolated position of each point, only used if ShouldInterpolate. */
+	TArray<FVector> RenderPositions;
+
+	/** World space location each point is pulled toward, filled by subclasses. Empty if the chain follows no target. */
+	TArray<FVector> FollowTargets;
+
+	/** Fraction of the distance to its follow target each free point closes in one simulation step. */
+	TArray<float> FollowStiffness;
+
+	/** FollowStiffness converted to the fraction closed per solver iteration. */
+	TArray<float> FollowIterationStiffness;
+
+	/** Lane buffers of the vectorized solver backend, reused between steps. */
+	FChainVectorSolver VectorSolver;
+
+	/** Multipliers of the XPBD solver backends, reused between steps. */
+	FChainXPBDSolver XPBDSolver;
+
+	/** Sink of the phase timings, null unless the chain is benchmarked. */
+	FChainPhaseTimings* PhaseTimings = nullptr;
+
+	/** Component space position of each point as last sent to the scene proxy. */
+	TArray<FVector3f> PackedRenderPoints;
+
+	/** Transform of each instance as last uploaded to the instanced mesh component. */
+	TArray<FTransform> UploadedTransforms;
+
+	/** Scratch buffer for the contiguous runs of dirty instances, reused between frames. */
+	TArray<FTransform> InstanceRunTransforms;
+
+	/** Async sweeps issued in the previous step when CollisionQueryMode is Async. */
+	TArray<FChainPendingSweep> PendingSweeps;
+
+	/** Whether RestoreSnapshot discarded the async sweeps in flight, the next consume sweeps blocking instead. */
+	bool bAsyncSweepsDiscarded = false;
+
+	/** Scratch buffer for the hits of the blocking sweeps, reused between points. */
+	TArray<FHitResult> SweepHits;
+
+	/** Scratch buffer for the objects found by the wake probe. */
+	TArray<FOverlapResult> WakeProbeOverlaps;
+
+	/** Self collision broadphase, rebuilt every step into the same arena. */
+	FChainSpatialHash SelfCollisionHash;
+
+	/** Simulated point the next chain to chain collision pass starts at, when the budget cuts a pass short. */
+	int32 ChainCollisionCursor = 0;
+
+	/** Contacts collected since the last OnCollide event, one per hit component. */
+	TArray<FHitResult> PendingContacts;
+
+	/** Contacts of the OnCollide event being broadcast, swapped with PendingContacts to keep both allocations. */
+	TArray<FHitResult> DispatchedContacts;
+
+	/** Strongest summed velocity since the last OnSoundReached event. */
+	FVector PendingSoundVelocity = FVector::ZeroVector;
+
+	/** Whether PendingSoundVelocity is waiting to be broadcast. */
+	bool bSoundPending = false;
+
+	/** World time of the last OnCollide event. */
+	double LastCollideEventTime = -UE_BIG_NUMBER;
+
+	/** World time of the last OnSoundReached event. */
+	double LastSoundEventTime = -UE_BIG_NUMBER;
+
+	/** Length of the chain from its start to each point, rebuilt lazily by the queries. */
+	mutable TArray<float> CumulativeLengths;
+
+	/** Bounds of the chain points, rebuilt lazily by the queries. */
+	mutable FBox CachedBounds = FBox(ForceInit);
+
+	/** Whether the chain moved since the query cache was built. */
+	mutable bool bQueryCacheDirty = true;
+
+	/** Resolved targets of AttachStartTo and AttachEndTo, mutable as they are resolved lazily by const queries. */
+	mutable FChainAttachment AttachStartCache, AttachEndCache;
+
+	/** Resolved components of AttachComponentToStart and AttachComponentToEnd. */
+	mutable FChainAttachment AttachComponentToStartCache, AttachComponentToEndCache;
+
+	//---data---
+public:
+	/**
+	 * The interpolation factor used for chain movement.
+	 */
+	UPROPERTY(EditAnywhere, Category = "ChainComponent|Chain Component")
+	float Lerp = 0.1;
+
+	/**
+	 * Delegate called when the chain reaches a sound threshold.
+	 * Called at most once per SoundEventInterval with the strongest velocity since the last call.
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "ChainComponent|Chain Component")
+	FOnSoundReached OnSoundReached;
+
+	/**
+	 * Delegate called when the chain collides with an object.
+	 * Called at most once per CollisionEventInterval with one hit per hit component since the last call.
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "ChainComponent|Chain Component")
+	FOnChainCollide OnCollide;
+
+	/**
+	 * Delegate called when a link of the chain breaks, with the first point of the link and its location.
+	 * Not limited by an interval, every broken link is reported once.
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "ChainComponent|Chain Component")
+	FOnChainBroken OnChainBroken;
+
+	/**
+	 * Reference to the static mesh used for the chain.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Chains static mesh reference"))
+	UStaticMesh* ChainMesh;
+
+	/**
+	 * Scale transform applied to each chain segment.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Transform scale of each chain"))
+	FVector Scale = FVector::OneVector;
+
+	/**
+	 * Number of segments in the chain.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Number of chain segments"))
+	int Segments = 10;
+
+	/**
+	 * Incremental rotation applied to each chain segment.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Incremental Transform rotation of each chain"))
+	FVector AdditiveRotation = FVector(0, 0, 45);
+
+	/**
+	 * The rest length of the chain segments.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|Chain", meta = (ShortToolTip = "Rest length of chains"))
+	float ChainLength = 1.5f;
+
+	/**
+	 * Determines if the chain uses local space for its transformations.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", meta = (ShortToolTip = "Is Local space", MakeEditWidget = true))
+	bool bIsLocal = true;
+
+	/**
+	 * The endpoint location of the chain.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", meta = (ShortToolTip = "Location of the end point", MakeEditWidget = true))
+	FVector EndPoint = FVector(100, 0, 0);
+
+	/**
+	 * Determines if the chain is attached at the start point.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", meta = (ShortToolTip = "Is attached to start point"))
+	bool AttachStart = true;
+
+	/**
+	 * Reference to the component to attach the start point to.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "Start point attachment component reference"))
+	FComponentReference AttachStartTo;
+
+	/**
+	 * The socket name for the start point attachment.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "Start point attachment socket name"))
+	FName AttachStartToSocket;
+
+	/**
+	 * Determines if the chain is attached at the end point.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "Is attached to end point"))
+	bool AttachEnd = true;
+
+	/**
+	 * Reference to the component to attach the end point to.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "End point attachment component reference"))
+	FComponentReference AttachEndTo;
+
+	/**
+	 * The socket name for the end point attachment.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttach", META = (ShortToolTip = "End point attachment socket name"))
+	FName AttachEndToSocket;
+
+	/**
+	 * Reference to the component for attaching to the start point.
+	 */
+	UPROPERTY(EditAnyWhere, Category = "ChainComponent|ChainAttachment", meta = (ShortToolTip = "Start point attachment component reference"))
+	FComponentReference AttachComponentToStart;
+
+	/**
+	 * Determines if the start attachment component should be rotated.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttachment", meta = (ShortToolTip = "Rotate start attachment component"))
+	bool RotateStartAttachment = true;
+
+	/**
+	 * Reference to the component for attaching to the end point.
+	 */
+	UPROPERTY(EditAnyWhere, Category = "ChainComponent|ChainAttachment", meta = (ShortToolTip = "Start point attachment component reference"))
+	FComponentReference AttachComponentToEnd;
+
+	/**
+	 * Determines if the end attachment component should be rotated.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainAttachment", meta = (ShortToolTip = "Rotate start attachment component"))
+	bool bRotateEndAttachment = true;
+
+	/**
+	 * The gravity scale applied to the chains.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (ShortToolTip = "Gravity scale of chains"))
+	float Gravity = 0.98f;
+
+	/**
+	 * The stiffness of the chains.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 1.0, ShortToolTip = "Stiffness of chains"))
+	int Stiffness = 10;
+
+	/**
+	 * The solver used to integrate gravity and the segment length constraints.
+	 * Vectorized converges slightly slower per iteration but processes four points per instruction.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (ShortToolTip = "Solver backend of chains"))
+	EChainSolverBackend SolverBackend = EChainSolverBackend::Scalar;
+
+	/**
+	 * The inverse stiffness of the segments for the XPBD solvers.
+	 * 0 makes the segments inextensible, larger values let the chain stretch like a rubber band.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 0.0, ShortToolTip = "XPBD compliance of chains"))
+	float Compliance = 0.0f;
+
+	/**
+	 * The relative segment stretch below which the XPBD solvers stop iterating before Stiffness iterations.
+	 * 0 always runs every iteration.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 0.0, ShortToolTip = "XPBD convergence tolerance"))
+	float SolverTolerance = 0.0f;
+
+	/**
+	 * The relative stretch of a link above which it breaks, e.g. 0.5 breaks links stretched to 150% of their length.
+	 * 0 makes the chain unbreakable. Soft chains need a compliance or few iterations to stretch far enough.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (ClampMin = 0.0, ShortToolTip = "Chain break stretch"))
+	float BreakStretch = 0.0f;
+
+	/**
+	 * The number of constraints per task of the XPBD Red-Black solver.
+	 * Chains with fewer than four times as many segments are solved on a single thread. 0 never splits.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 0, ShortToolTip = "XPBD constraints per task"))
+	int32 ParallelBatchSize = 256;
+
+	/**
+	 * The number of fixed substeps simulated per second, independent of the frame rate.
+	 * Gravity is tuned for 60 substeps per second. 0 runs one step per simulated frame like before.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 0.0, ShortToolTip = "Substeps per second"))
+	float SubstepRate = 60.0f;
+
+	/**
+	 * The maximal number of substeps per step, the remaining time is dropped to avoid a spiral of death.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 1, ShortToolTip = "Maximal substeps per step"))
+	int32 MaxSubsteps = 4;
+
+	/**
+	 * Determines if the rendered chain is interpolated between the last two substeps.
+	 * Smooths chains simulated below the frame rate at the cost of one substep of latency.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (ShortToolTip = "Is rendering interpolated between substeps"))
+	bool bInterpolateSubsteps = true;
+
+	/**
+	 * The friction coefficient of the chains.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainPhysic", meta = (UIMin = 0.1, UIMax = 1.0, ShortToolTip = "Friction of chains"))
+	float Friction = 0.3f;
+
+	/**
+	 * The width of the chain for world collision detection.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Chains width for world collision detection"))
+	float ChainWidth = 20;
+
+	/**
+	 * How the chain points query the world for collision.
+	 * Async overlaps the sweeps with the rest of the frame at the cost of one frame of latency.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Chains world collision query mode"))
+	EChainCollisionQueryMode CollisionQueryMode = EChainCollisionQueryMode::Synchronous;
+
+	/**
+	 * Determines if self-collision is enabled for the chains.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (UIMin = 0.0, UIMax = 1.0, ShortToolTip = "Is self collision enabled"))
+	bool bSelfCollision = false;
+
+	/**
+	 * The width for self-collision detection of the chains.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Chains width for self collision detection"))
+	float SelfCollisionWidth = 20;
+
+	/**
+	 * The threshold for self-collision detection of the chain.
+	 * If the force exceeds this value, self-collision will be triggered.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Self collision force threshold"))
+	float SelfCollisionThreshold = 0.05f;
+
+	/**
+	 * Determines if self-collision candidates come from a spatial hash keyed on SelfCollisionWidth.
+	 * If false, every point is tested against every other point, which is quadratic in the segment count.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Is self collision broadphase enabled"))
+	bool bSelfCollisionBroadphase = true;
+
+	/**
+	 * Determines if the chain collides with other chains stepped by the chain simulation subsystem.
+	 * Chains that tick on their own are not part of chain to chain collision.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ShortToolTip = "Is chain to chain collision enabled"))
+	bool bChainCollision = false;
+
+	/**
+	 * The radius of each chain point against other chains, two points touch at the sum of their radii.
+	 * Chains with a radius of 0 or less take no part in chain to chain collision.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (ClampMin = 0.1, EditCondition = "bChainCollision", ShortToolTip = "Chain to chain collision radius"))
+	float ChainCollisionRadius = 10.0f;
+
+	/**
+	 * The collision groups the chain belongs to.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (Bitmask, EditCondition = "bChainCollision", ShortToolTip = "Chain collision groups"))
+	int32 ChainCollisionGroups = 1;
+
+	/**
+	 * The collision groups the chain collides with. Two chains collide only if each one is in the mask of the other.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (Bitmask, EditCondition = "bChainCollision", ShortToolTip = "Chain collision mask"))
+	int32 ChainCollisionMask = -1;
+
+	/**
+	 * The number of frames to skip when rendering the chain.
+	 * This allows for optimization by reducing the update frequency.
+	 * Default value is 0.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (UIMin = 0.0, ShortToolTip = "Chains skip counter by frame"))
+	int Skip = 0;
+
+	/**
+	 * Minimal change of a link transform before its instance is uploaded again.
+	 * Chains at rest do not touch the instance buffer at all.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainRender", meta = (UIMin = 0.0, ShortToolTip = "Instance transform upload tolerance"))
+	float InstanceUpdateTolerance = 0.01f;
+
+	/**
+	 * Determines if the chain is drawn as instances of ChainMesh or as a cable tube by its own scene proxy.
+	 * The cable sends one packed buffer per frame instead of updating an instance per moved point.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (ShortToolTip = "Chain render mode"))
+	EChainRenderMode RenderMode = EChainRenderMode::Instances;
+
+	/**
+	 * The radius of the cable tube.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (ClampMin = 0.0, EditCondition = "RenderMode == EChainRenderMode::Cable", ShortToolTip = "Cable radius"))
+	float CableRadius = 2.0f;
+
+	/**
+	 * The number of vertices around the cable tube.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (ClampMin = 3, ClampMax = 32, EditCondition = "RenderMode == EChainRenderMode::Cable", ShortToolTip = "Cable sides"))
+	int32 CableSides = 8;
+
+	/**
+	 * The length of cable covered by the texture once.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (ClampMin = 0.01, EditCondition = "RenderMode == EChainRenderMode::Cable", ShortToolTip = "Cable texture length"))
+	float CableTextureLength = 100.0f;
+
+	/**
+	 * Determines if the chain is simulated in batch with every other chain of the world.
+	 * Batched chains run their solver on worker threads and do not tick individually.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (ShortToolTip = "Is chain simulated by the world subsystem"))
+	bool bUseSimulationSubsystem = true;
+
+	/**
+	 * Determines if debug visualization for the chains is enabled.
+	 * If true, debug drawings will be displayed in the editor.
+	 * Default value is false.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (ShortToolTip = "Is chains debug drawer enabled"))
+	bool bDrawDebugger = false;
+
+	/**
+	 * Reference to the instanced static mesh component used for the chain.
+	 * This component handles the instancing of the chain meshes for better performance.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRender", meta = (UIMin = 0.0, ShortToolTip = "Instanced component object reference"))
+	UInstancedStaticMeshComponent* InstanceComponent;
+
+	/**
+	 * The velocity threshold for triggering the OnSoundReached event.
+	 * When the chain's velocity exceeds this value, the event will be called.
+	 * Default value is 1.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainSound", meta = (UIMin = 0.0, ShortToolTip = "Chains velocity threshold for OnSoundReach event call"))
+	float SoundThreshold = 1;
+
+	/**
+	 * The number of frames to skip before calling the OnSoundReached event.
+	 * This helps in controlling the frequency of the event calls.
+	 * Default value is 1.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainSound", meta = (UIMin = 0.0, ShortToolTip = "Skip counter by frame for calling OnSoundReach event call"))
+	int SoundSkip = 1;
+
+	/**
+	 * The minimal time in seconds between two OnSoundReached events.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainSound", meta = (UIMin = 0.0, ShortToolTip = "Minimal seconds between sound events"))
+	float SoundEventInterval = 0.1f;
+
+	/**
+	 * The minimal time in seconds between two OnCollide events.
+	 * Contacts found in between are merged into the next event.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainCollision", meta = (UIMin = 0.0, ShortToolTip = "Minimal seconds between collide events"))
+	float CollisionEventInterval = 0.1f;
+
+	/**
+	 * Determines if the chain stops simulating once it is at rest.
+	 * A sleeping chain wakes up when an attachment moves, a force is applied or a dynamic object gets close.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainSleep", meta = (ShortToolTip = "Is chain allowed to sleep"))
+	bool bAllowSleep = true;
+
+	/**
+	 * The mean squared displacement of the free points per step below which the chain is considered at rest.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainSleep", meta = (UIMin = 0.0, ShortToolTip = "Kinetic energy threshold for sleeping"))
+	float SleepEnergyThreshold = 0.001f;
+
+	/**
+	 * The number of consecutive resting steps before the chain falls asleep.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainSleep", meta = (UIMin = 1, ShortToolTip = "Resting steps before sleeping"))
+	int32 SleepFrames = 30;
+
+	/**
+	 * The distance an attachment has to move to wake the chain up.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainSleep", meta = (UIMin = 0.0, ShortToolTip = "Attachment movement tolerance while sleeping"))
+	float SleepAttachmentTolerance = 0.1f;
+
+	/**
+	 * The number of frames between two overlap probes for moving dynamic objects near a sleeping chain.
+	 * 0 disables the probe.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadWrite, Category = "ChainComponent|ChainSleep", meta = (UIMin = 0, ShortToolTip = "Frames between wake probes"))
+	int32 WakeProbeInterval = 10;
+
+	/**
+	 * Determines if the significance manager selects the level of detail of the chain.
+	 * If false, the chain always uses full detail.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainLOD", meta = (ShortToolTip = "Is chain LOD driven by significance"))
+	bool bUseSignificance = true;
+
+	/**
+	 * Levels of detail sorted by ascending MaxDistance.
+	 * Chains farther away than the last entry keep using it.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainLOD", meta = (ShortToolTip = "Chain LOD settings by distance"))
+	TArray<FChainLODSettings> LODSettings;
+
+	/**
+	 * Level of detail of chains that were not rendered recently, MaxDistance is ignored.
+	 * A TickInterval of 0 freezes offscreen chains, only their pins and bounds keep following the attachments then.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainLOD", meta = (ShortToolTip = "Chain LOD settings when offscreen"))
+	FChainLODSettings OffscreenLODSettings = FChainLODSettings(0.0f, 8, 2, false, 2);
+
+	/**
+	 * Seconds without being rendered before the chain is considered offscreen.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainLOD", meta = (UIMin = 0.0, ShortToolTip = "Offscreen delay in seconds"))
+	float OffscreenDelay = 0.5f;
+
+	/**
+	 * The number of snapshots kept for rewinding, 0 disables snapshots.
+	 * A snapshot takes 12 bytes per point.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainSnapshot", meta = (ClampMin = 0, ShortToolTip = "Snapshots kept for rewinding"))
+	int32 SnapshotCapacity = 0;
+
+	/**
+	 * The number of simulation steps between two automatic snapshots.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainSnapshot", meta = (ClampMin = 1, ShortToolTip = "Steps between snapshots"))
+	int32 SnapshotInterval = 1;
+
+	/**
+	 * Determines if the server replicates the chain to the clients. The owning actor has to replicate.
+	 * Only keyframe points are sent, clients simulate the chain and pull the keyframes toward the server.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainReplication", meta = (ShortToolTip = "Is chain state replicated"))
+	bool bReplicateChain = false;
+
+	/**
+	 * The number of points from one keyframe point to the next. The last point is always a keyframe.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainReplication", meta = (ClampMin = 1, EditCondition = "bReplicateChain", ShortToolTip = "Points per keyframe"))
+	int32 ReplicationKeyframeStride = 8;
+
+	/**
+	 * The maximal number of keyframes sent per update, the most diverged keyframes go first.
+	 * Together with ReplicationInterval it caps the bandwidth of the chain.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainReplication", meta = (ClampMin = 1, EditCondition = "bReplicateChain", ShortToolTip = "Keyframes per update"))
+	int32 ReplicationMaxKeyframes = 8;
+
+	/**
+	 * Seconds between two keyframe updates of the most significant chains.
+	 * Every further level of detail adds one interval, offscreen chains wait as long as the last level.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainReplication", meta = (ClampMin = 0.0, EditCondition = "bReplicateChain", ShortToolTip = "Seconds between updates"))
+	float ReplicationInterval = 0.1f;
+
+	/**
+	 * The distance in cm a keyframe point has to drift from its last sent location before it is sent again.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainReplication", meta = (ClampMin = 1.0, EditCondition = "bReplicateChain", ShortToolTip = "Keyframe tolerance"))
+	float ReplicationTolerance = 2.0f;
+
+	/**
+	 * Fraction of the distance to its replicated location a client keyframe point closes per step.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainReplication", meta = (ClampMin = 0.0, ClampMax = 1.0, EditCondition = "bReplicateChain", ShortToolTip = "Keyframe correction per step"))
+	float ReplicationBlend = 0.3f;
+
+	/**
+	 * Determines if the chain starts from the baked rest pose.
+	 * The pose is ignored once a setting it depends on changed, until it is baked again.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRestPose", meta = (ShortToolTip = "Start from the baked rest pose"))
+	bool bUseRestPose = true;
+
+	/**
+	 * The maximal simulated time in seconds when baking the rest pose. Baking stops earlier once the chain falls asleep.
+	 */
+	UPROPERTY(EditAnyWhere, BlueprintReadOnly, Category = "ChainComponent|ChainRestPose", meta = (ClampMin = 0.0, ShortToolTip = "Rest pose bake duration in seconds"))
+	float RestPoseBakeDuration = 10.0f;
+
+	/**
+	 * The baked position of each point, in the frame of CalculateRestPoseFrame.
+	 */
+	UPROPERTY(VisibleAnywhere, AdvancedDisplay, Category = "ChainComponent|ChainRestPose")
+	TArray<FVector> RestPose;
+
+	/**
+	 * Offset from the first to the last point in the frame of the rest pose when it was baked.
+	 */
+	UPROPERTY()
+	FVector RestPoseSpan = FVector::ZeroVector;
+
+	/**
+	 * GetRestPoseHash at the time RestPose was baked.
+	 */
+	UPROPERTY()
+	uint32 RestPoseHash = 0;
 
 private:
 	/**
@@ -475,7 +1815,7 @@ private:
 	/**
 	 *
 	 */
-	void CalculateChainPoint(bool bIsAttached, FComponentReference& AttachRef, FName AttachSocket, int32 PointIndex, bool bUseEndPoint = false);
+	void CalculateChainPoint(bool bIsAttached, const FComponentReference& AttachRef, FChainAttachment& AttachCache, FName AttachSocket, int32 PointIndex, bool bUseEndPoint = false);
 
 	/**
 	 *
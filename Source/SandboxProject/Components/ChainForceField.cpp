@@ -0,0 +1,46 @@
+// This is Sandbox Project.
+
+#include "ChainForceField.h"
+
+bool FChainForceField::Overlaps(const FBox& Box) const
+{
+	return IsUnbounded() || Box.ComputeSquaredDistanceToPoint(Location) <= FMath::Square(Radius);
+}
+
+FVector FChainForceField::Sample(const FVector& Point, float Time) const
+{
+	const FVector Offset = Point - Location;
+	float Scale = Strength;
+
+	if (! IsUnbounded())
+	{
+		const double DistanceSquared = Offset.SizeSquared();
+		if (DistanceSquared >= FMath::Square(Radius)) return FVector::ZeroVector;
+
+		if (bFalloff)
+		{
+			Scale *= 1.0f - FMath::Sqrt(static_cast<float>(DistanceSquared)) / Radius;
+		}
+	}
+
+	switch (Type)
+	{
+		case EChainForceFieldType::Wind:
+		{
+			// The noise field drifts with the wind, so gusts visibly travel along the chains.
+			const FVector NoisePoint = (Point - Direction * (NoiseSpeed * Time)) * NoiseFrequency;
+			const float Gust = 1.0f + NoiseAmplitude * FMath::PerlinNoise3D(NoisePoint);
+
+			return Direction * (Scale * Gust);
+		}
+
+		case EChainForceFieldType::Radial:
+			return Offset.GetSafeNormal() * Scale;
+
+		case EChainForceFieldType::Vortex:
+			return FVector::CrossProduct(Direction, Offset).GetSafeNormal() * Scale;
+
+		default:
+			return FVector::ZeroVector;
+	}
+}
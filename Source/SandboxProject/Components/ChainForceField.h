@@ -0,0 +1,111 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChainForceField.generated.h"
+
+/**
+ *	Enum representing the shape of the acceleration of a chain force field.
+ */
+UENUM(BlueprintType)
+enum class EChainForceFieldType : uint8
+{
+	/** Constant acceleration along Direction, with gusts from a noise field */
+	Wind UMETA(DisplayName = "Wind"),
+
+	/** Acceleration away from Location, a negative strength pulls toward it */
+	Radial UMETA(DisplayName = "Radial"),
+
+	/** Acceleration around the axis through Location along Direction */
+	Vortex UMETA(DisplayName = "Vortex"),
+};
+
+/**
+ * A volume that accelerates every chain point inside it, registered with the chain simulation subsystem.
+ */
+USTRUCT(BlueprintType)
+struct SANDBOXPROJECT_API FChainForceField
+{
+	GENERATED_BODY()
+
+	/**
+	 * The shape of the acceleration.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field")
+	EChainForceFieldType Type = EChainForceFieldType::Wind;
+
+	/**
+	 * The world space center of the field.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field")
+	FVector Location = FVector::ZeroVector;
+
+	/**
+	 * The radius of the field, 0 or less makes the field unbounded.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field")
+	float Radius = 0.0f;
+
+	/**
+	 * The wind direction or the vortex axis, normalized by the subsystem.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field")
+	FVector Direction = FVector::ForwardVector;
+
+	/**
+	 * The acceleration in cm/s², or the velocity change in cm/s for impulses.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field")
+	float Strength = 500.0f;
+
+	/**
+	 * Fraction of the wind strength added or removed by gusts.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field", meta = (ClampMin = 0.0))
+	float NoiseAmplitude = 0.5f;
+
+	/**
+	 * Spatial frequency of the gusts, in cycles per cm.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field", meta = (ClampMin = 0.0))
+	float NoiseFrequency = 0.002f;
+
+	/**
+	 * Speed the gusts travel at along Direction, in cm/s.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field")
+	float NoiseSpeed = 300.0f;
+
+	/**
+	 * Determines if bounded fields fade out linearly toward their radius.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field")
+	bool bFalloff = true;
+
+	/**
+	 * Determines if Strength is a velocity change applied once instead of a continuous acceleration.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chain Force Field")
+	bool bImpulse = false;
+
+	/**
+	 * @return True if the field has no radius and affects every chain.
+	 */
+	FORCEINLINE bool IsUnbounded() const { return Radius <= 0.0f; }
+
+	/**
+	 * @return True if the field reaches into the box.
+	 */
+	bool Overlaps(const FBox& Box) const;
+
+	/**
+	 * @param Point The world space location to sample.
+	 * @param Time The world time in seconds, moves the wind gusts.
+	 * @return The acceleration at the point, or the velocity change for impulses.
+	 */
+	FVector Sample(const FVector& Point, float Time) const;
+
+	/** Serial number of an impulse, lets every chain apply it exactly once. Set by the subsystem. */
+	uint32 ImpulseSerial = 0;
+};
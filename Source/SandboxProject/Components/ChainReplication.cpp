@@ -0,0 +1,13 @@
+// This is Sandbox Project.
+
+#include "ChainReplication.h"
+
+void FChainKeyframe::PostReplicatedAdd(const FChainKeyframeArray& InArraySerializer)
+{
+	bPending = true;
+}
+
+void FChainKeyframe::PostReplicatedChange(const FChainKeyframeArray& InArraySerializer)
+{
+	bPending = true;
+}
@@ -0,0 +1,63 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "ChainReplication.generated.h"
+
+struct FChainKeyframeArray;
+
+/**
+ * Authoritative location of one keyframe point of a replicated chain.
+ */
+USTRUCT()
+struct SANDBOXPROJECT_API FChainKeyframe : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** The chain point the keyframe belongs to. */
+	UPROPERTY()
+	uint16 PointIndex = 0;
+
+	/** World space location of the point, rounded to whole centimeters on the wire. */
+	UPROPERTY()
+	FVector_NetQuantize Location = FVector::ZeroVector;
+
+	/** Whether the client still has to pull its point toward Location. Not replicated. */
+	bool bPending = false;
+
+	void PostReplicatedAdd(const FChainKeyframeArray& InArraySerializer);
+	void PostReplicatedChange(const FChainKeyframeArray& InArraySerializer);
+};
+
+/**
+ * Keyframe points of a replicated chain.
+ *
+ * The server only marks the keyframes it updates as dirty, so each net update carries the changed
+ * keyframes alone. Clients simulate every point themselves and pull the keyframe points toward
+ * the replicated locations.
+ */
+USTRUCT()
+struct SANDBOXPROJECT_API FChainKeyframeArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FChainKeyframe> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FChainKeyframe, FChainKeyframeArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FChainKeyframeArray> : public TStructOpsTypeTraitsBase2<FChainKeyframeArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
@@ -0,0 +1,163 @@
+// This is Sandbox Project.
+
+#include "ChainSceneProxy.h"
+#include "ChainComponent.h"
+#include "Engine/Engine.h"
+#include "Materials/Material.h"
+#include "MaterialShared.h"
+#include "SceneManagement.h"
+
+FChainSceneProxy::FChainSceneProxy(const UChainComponent* Component)
+	: FPrimitiveSceneProxy(Component)
+	, Material(Component->GetCableMaterial())
+	, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetFeatureLevel()))
+	, Radius(FMath::Max(Component->CableRadius, UE_KINDA_SMALL_NUMBER))
+	, Sides(FMath::Max(Component->CableSides, 3))
+	, TextureLength(FMath::Max(Component->CableTextureLength, UE_KINDA_SMALL_NUMBER))
+{
+	bWillEverBeLit = true;
+
+	if (! Material)
+	{
+		Material = UMaterial::GetDefaultMaterial(MD_Surface);
+	}
+
+	Points.Append(Component->GetPackedRenderPoints().GetData(), Component->GetPackedRenderPoints().Num());
+	BrokenLinks.Append(Component->GetBrokenLinkIndices().GetData(), Component->GetBrokenLinkIndices().Num());
+	BuildTube();
+}
+
+SIZE_T FChainSceneProxy::GetTypeHash() const
+{
+	static size_t UniquePointer;
+	return reinterpret_cast<size_t>(&UniquePointer);
+}
+
+void FChainSceneProxy::SetPoints_RenderThread(TArray<FVector3f>&& InPoints, TArray<int32>&& InBrokenLinks)
+{
+	check(IsInRenderingThread());
+
+	Points = MoveTemp(InPoints);
+	BrokenLinks = MoveTemp(InBrokenLinks);
+	BuildTube();
+}
+
+void FChainSceneProxy::BuildTube()
+{
+	Vertices.Reset();
+	Indices.Reset();
+
+	const int32 NumPoints = Points.Num();
+	if (NumPoints < 2) return;
+
+	const int32 RingSize = Sides + 1;
+	Vertices.Reserve(NumPoints * RingSize);
+	Indices.Reserve((NumPoints - 1) * Sides * 6);
+
+	FVector3f Normal = FVector3f::ZeroVector;
+	float Distance = 0.0f;
+
+	// First broken link at or after the link to the previous point.
+	int32 BreakCursor = 0;
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const bool bLinkedToPrev = i > 0 && ! (BrokenLinks.IsValidIndex(BreakCursor) && BrokenLinks[BreakCursor] == i - 1);
+
+		if (i > 0 && ! bLinkedToPrev)
+		{
+			BreakCursor++;
+		}
+
+		const bool bLinkedToNext = i < NumPoints - 1 && ! (BrokenLinks.IsValidIndex(BreakCursor) && BrokenLinks[BreakCursor] == i);
+
+		const FVector3f& Prev = Points[bLinkedToPrev ? i - 1 : i];
+		const FVector3f& Next = Points[bLinkedToNext ? i + 1 : i];
+		const FVector3f Tangent = (Next - Prev).GetSafeNormal(UE_SMALL_NUMBER, FVector3f::ForwardVector);
+
+		// Parallel transport keeps the rings from twisting, only the first ring picks an arbitrary normal.
+		Normal = (Normal - Tangent * FVector3f::DotProduct(Normal, Tangent)).GetSafeNormal();
+		if (Normal.IsZero())
+		{
+			FVector3f UnusedAxis;
+			Tangent.FindBestAxisVectors(Normal, UnusedAxis);
+		}
+
+		const FVector3f Binormal = FVector3f::CrossProduct(Tangent, Normal);
+
+		if (bLinkedToPrev)
+		{
+			Distance += FVector3f::Dist(Points[i - 1], Points[i]);
+		}
+
+		for (int32 Side = 0; Side <= Sides; Side++)
+		{
+			const float Angle = UE_TWO_PI * Side / Sides;
+			const FVector3f Outward = Normal * FMath::Cos(Angle) + Binormal * FMath::Sin(Angle);
+
+			Vertices.Emplace(Points[i] + Outward * Radius, Tangent, Outward, FVector2f(static_cast<float>(Side) / Sides, Distance / TextureLength), FColor::White);
+		}
+
+		if (bLinkedToPrev)
+		{
+			const uint32 RingStart = (i - 1) * RingSize;
+
+			for (int32 Side = 0; Side < Sides; Side++)
+			{
+				const uint32 A = RingStart + Side;
+				const uint32 B = A + RingSize;
+
+				Indices.Append({A, A + 1, B, A + 1, B + 1, B});
+			}
+		}
+	}
+}
+
+void FChainSceneProxy::GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMeshElementCollector& Collector) const
+{
+	if (Indices.Num() == 0) return;
+
+	FMaterialRenderProxy* MaterialProxy = Material->GetRenderProxy();
+
+	if (AllowDebugViewmodes() && ViewFamily.EngineShowFlags.Wireframe && GEngine->WireframeMaterial)
+	{
+		FColoredMaterialRenderProxy* WireframeMaterial = new FColoredMaterialRenderProxy(GEngine->WireframeMaterial->GetRenderProxy(), FLinearColor(0.0f, 0.5f, 1.0f));
+		Collector.RegisterOneFrameMaterialProxy(WireframeMaterial);
+		MaterialProxy = WireframeMaterial;
+	}
+
+	for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+	{
+		if (! (VisibilityMap & (1 << ViewIndex))) continue;
+
+		FDynamicMeshBuilder MeshBuilder(Views[ViewIndex]->GetFeatureLevel());
+		MeshBuilder.AddVertices(Vertices);
+		MeshBuilder.AddTriangles(Indices);
+		MeshBuilder.GetMesh(GetLocalToWorld(), MaterialProxy, SDPG_World, false, false, ViewIndex, Collector);
+	}
+}
+
+FPrimitiveViewRelevance FChainSceneProxy::GetViewRelevance(const FSceneView* View) const
+{
+	FPrimitiveViewRelevance Result;
+	Result.bDrawRelevance = IsShown(View);
+	Result.bShadowRelevance = IsShadowCast(View);
+	Result.bDynamicRelevance = true;
+	Result.bRenderInMainPass = ShouldRenderInMainPass();
+	Result.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
+	Result.bRenderCustomDepth = ShouldRenderCustomDepth();
+	MaterialRelevance.SetPrimitiveViewRelevance(Result);
+	Result.bVelocityRelevance = DrawsVelocity() && Result.bOpaque && Result.bRenderInMainPass;
+
+	return Result;
+}
+
+bool FChainSceneProxy::CanBeOccluded() const
+{
+	return ! MaterialRelevance.bDisableDepthTest;
+}
+
+uint32 FChainSceneProxy::GetMemoryFootprint() const
+{
+	return sizeof(*this) + GetAllocatedSize() + Points.GetAllocatedSize() + BrokenLinks.GetAllocatedSize() + Vertices.GetAllocatedSize() + Indices.GetAllocatedSize();
+}
@@ -0,0 +1,72 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PrimitiveSceneProxy.h"
+#include "DynamicMeshBuilder.h"
+#include "Materials/MaterialRelevance.h"
+
+class UChainComponent;
+class UMaterialInterface;
+
+/**
+ * Render thread representation of a chain drawn as a cable tube.
+ *
+ * The game thread sends the chain points once per frame as a packed buffer of component space positions.
+ * The proxy derives the ring frames by parallel transport and builds the tube on the render thread,
+ * so there are no per point instance transforms, instance bounds or instance buffer updates.
+ * A broken chain is drawn as one tube per piece.
+ */
+class FChainSceneProxy final : public FPrimitiveSceneProxy
+{
+public:
+	FChainSceneProxy(const UChainComponent* Component);
+
+	virtual SIZE_T GetTypeHash() const override;
+	virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMeshElementCollector& Collector) const override;
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override;
+	virtual bool CanBeOccluded() const override;
+	virtual uint32 GetMemoryFootprint() const override;
+
+	/**
+	 * Replaces the chain points and rebuilds the tube. Called on the render thread.
+	 *
+	 * @param InPoints Component space position of each chain point.
+	 * @param InBrokenLinks First point of every broken link, ascending. The tube is split at these links.
+	 */
+	void SetPoints_RenderThread(TArray<FVector3f>&& InPoints, TArray<int32>&& InBrokenLinks);
+
+private:
+	/**
+	 * Generates the tube vertices and indices around the current points.
+	 */
+	void BuildTube();
+
+	/** Material of the tube. */
+	UMaterialInterface* Material;
+
+	/** Relevance of the material, decides the passes the tube is drawn in. */
+	FMaterialRelevance MaterialRelevance;
+
+	/** Component space position of each chain point. */
+	TArray<FVector3f> Points;
+
+	/** First point of every broken link, ascending. */
+	TArray<int32> BrokenLinks;
+
+	/** Vertices of the tube, rebuilt when the points change and shared by all views. */
+	TArray<FDynamicMeshVertex> Vertices;
+
+	/** Triangle indices of the tube. */
+	TArray<uint32> Indices;
+
+	/** Radius of the tube. */
+	float Radius;
+
+	/** Number of vertices around the tube. */
+	int32 Sides;
+
+	/** Length of the tube covered by the texture once along V. */
+	float TextureLength;
+};
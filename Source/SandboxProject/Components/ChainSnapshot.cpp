@@ -0,0 +1,130 @@
+// This is Sandbox Project.
+
+#include "ChainSnapshot.h"
+
+namespace ChainSnapshot
+{
+	/** Smallest quantization step, keeps the steps of a chain collapsed to a point finite. */
+	constexpr float MinStep = 1.0e-4f;
+
+	/** Largest value of a quantized position. */
+	constexpr float MaxPosition = TNumericLimits<uint16>::Max();
+
+	/** Largest magnitude of a quantized velocity. */
+	constexpr float MaxVelocity = TNumericLimits<int16>::Max();
+}
+
+void FChainSnapshot::Encode(TConstArrayView<FVector> Positions, TConstArrayView<FVector> OldPositions)
+{
+	const int32 NumPoints = Positions.Num();
+	check(OldPositions.Num() == NumPoints);
+
+	QuantizedPositions.SetNumUninitialized(NumPoints * 3, EAllowShrinking::No);
+	QuantizedVelocities.SetNumUninitialized(NumPoints * 3, EAllowShrinking::No);
+
+	FBox Bounds(ForceInit);
+	double MaxVelocity = 0.0;
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		Bounds += Positions[i];
+		MaxVelocity = FMath::Max(MaxVelocity, (Positions[i] - OldPositions[i]).GetAbsMax());
+	}
+
+	Origin = NumPoints > 0 ? Bounds.Min : FVector::ZeroVector;
+	PositionStep = FMath::Max(static_cast<float>((NumPoints > 0 ? Bounds.GetSize().GetMax() : 0.0) / ChainSnapshot::MaxPosition), ChainSnapshot::MinStep);
+	VelocityStep = FMath::Max(static_cast<float>(MaxVelocity / ChainSnapshot::MaxVelocity), ChainSnapshot::MinStep);
+
+	const double InvPositionStep = 1.0 / PositionStep;
+	const double InvVelocityStep = 1.0 / VelocityStep;
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const FVector Position = (Positions[i] - Origin) * InvPositionStep;
+		const FVector Velocity = (Positions[i] - OldPositions[i]) * InvVelocityStep;
+
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			QuantizedPositions[i * 3 + Axis] = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt32(Position[Axis]), 0, static_cast<int32>(ChainSnapshot::MaxPosition)));
+			QuantizedVelocities[i * 3 + Axis] = static_cast<int16>(FMath::Clamp(FMath::RoundToInt32(Velocity[Axis]), -static_cast<int32>(ChainSnapshot::MaxVelocity), static_cast<int32>(ChainSnapshot::MaxVelocity)));
+		}
+	}
+}
+
+void FChainSnapshot::Decode(TArrayView<FVector> Positions, TArrayView<FVector> OldPositions) const
+{
+	const int32 NumPoints = Num();
+	check(Positions.Num() == NumPoints && OldPositions.Num() == NumPoints);
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const uint16* Position = QuantizedPositions.GetData() + i * 3;
+		const int16* Velocity = QuantizedVelocities.GetData() + i * 3;
+
+		Positions[i] = Origin + FVector(Position[0], Position[1], Position[2]) * PositionStep;
+		OldPositions[i] = Positions[i] - FVector(Velocity[0], Velocity[1], Velocity[2]) * VelocityStep;
+	}
+}
+
+void FChainSnapshotBuffer::Reset(int32 Capacity)
+{
+	Slots.SetNum(FMath::Max(Capacity, 0));
+	Head = 0;
+	Count = 0;
+
+	for (FChainSnapshot& Slot : Slots)
+	{
+		Slot.Step = INDEX_NONE;
+	}
+}
+
+FChainSnapshot& FChainSnapshotBuffer::Add()
+{
+	check(Slots.Num() > 0);
+
+	if (Count < Slots.Num())
+	{
+		return Slots[GetSlot(Count++)];
+	}
+
+	// The ring is full, the oldest slot becomes the newest.
+	FChainSnapshot& Slot = Slots[Head];
+	Head = (Head + 1) % Slots.Num();
+
+	return Slot;
+}
+
+const FChainSnapshot* FChainSnapshotBuffer::FindLatest(int64 Step) const
+{
+	for (int32 Index = Count - 1; Index >= 0; Index--)
+	{
+		const FChainSnapshot& Snapshot = Slots[GetSlot(Index)];
+
+		if (Snapshot.Step <= Step)
+		{
+			return &Snapshot;
+		}
+	}
+
+	return nullptr;
+}
+
+void FChainSnapshotBuffer::DiscardAfter(int64 Step)
+{
+	while (Count > 0 && Slots[GetSlot(Count - 1)].Step > Step)
+	{
+		Slots[GetSlot(--Count)].Step = INDEX_NONE;
+	}
+}
+
+SIZE_T FChainSnapshotBuffer::GetAllocatedSize() const
+{
+	SIZE_T Size = Slots.GetAllocatedSize();
+
+	for (const FChainSnapshot& Slot : Slots)
+	{
+		Size += Slot.GetAllocatedSize();
+	}
+
+	return Size;
+}
@@ -0,0 +1,130 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Compact copy of the simulation state of a chain after one step.
+ *
+ * Positions are quantized to 16 bits per axis inside the bounds of the chain, and the Verlet velocity
+ * (position minus old position) to 16 signed bits per axis with its own scale, so a point takes 12 bytes
+ * instead of the 48 bytes of two FVector. A restored chain is within half a quantization step of the
+ * captured one and steps deterministically from there.
+ */
+struct SANDBOXPROJECT_API FChainSnapshot
+{
+	/** Simulation step the snapshot was captured after, INDEX_NONE for an empty slot. */
+	int64 Step = INDEX_NONE;
+
+	/** Unconsumed simulation time of the fixed timestep. */
+	float TimeAccumulator = 0.0f;
+
+	/** Frame counter of the chain, the level of detail intervals and the wake probes are scheduled by it. */
+	uint32 Frame = 0;
+
+	/** Consecutive resting steps of the sleep detection. */
+	int32 RestingSteps = 0;
+
+	/** Whether the chain was asleep. */
+	bool bSleeping = false;
+
+	/** Sorted indices of the broken links, a link connects a point to the next one. */
+	TArray<int32> BrokenLinkIndices;
+
+	/**
+	 * Quantizes the positions and the old positions into the snapshot, reusing its allocations.
+	 */
+	void Encode(TConstArrayView<FVector> Positions, TConstArrayView<FVector> OldPositions);
+
+	/**
+	 * Writes the dequantized positions and old positions, both views must hold Num points.
+	 */
+	void Decode(TArrayView<FVector> Positions, TArrayView<FVector> OldPositions) const;
+
+	/**
+	 * @return The number of points in the snapshot.
+	 */
+	FORCEINLINE int32 Num() const { return QuantizedPositions.Num() / 3; }
+
+	/**
+	 * @return The memory allocated by the quantized buffers.
+	 */
+	FORCEINLINE SIZE_T GetAllocatedSize() const { return QuantizedPositions.GetAllocatedSize() + QuantizedVelocities.GetAllocatedSize() + BrokenLinkIndices.GetAllocatedSize(); }
+
+private:
+	/** Minimum corner of the chain bounds, the origin of the quantized positions. */
+	FVector Origin = FVector::ZeroVector;
+
+	/** Distance covered by one unit of a quantized position. */
+	float PositionStep = 1.0f;
+
+	/** Distance covered by one unit of a quantized velocity. */
+	float VelocityStep = 1.0f;
+
+	/** Three unsigned units per point. */
+	TArray<uint16> QuantizedPositions;
+
+	/** Three signed units per point. */
+	TArray<int16> QuantizedVelocities;
+};
+
+/**
+ * Ring buffer of chain snapshots. Slots are overwritten oldest first and keep their allocations,
+ * so capturing a snapshot does not allocate once the buffer is full.
+ */
+class SANDBOXPROJECT_API FChainSnapshotBuffer
+{
+public:
+	/**
+	 * Drops every snapshot and resizes the ring.
+	 *
+	 * @param Capacity The number of snapshots kept, 0 disables the buffer.
+	 */
+	void Reset(int32 Capacity);
+
+	/**
+	 * @return The slot of the next snapshot, which replaces the oldest one if the ring is full.
+	 */
+	FChainSnapshot& Add();
+
+	/**
+	 * @return The newest snapshot captured at or before the step, or null if there is none.
+	 */
+	const FChainSnapshot* FindLatest(int64 Step) const;
+
+	/**
+	 * Drops the snapshots captured after the step, they belong to a timeline that was rewound.
+	 */
+	void DiscardAfter(int64 Step);
+
+	/**
+	 * @return The number of snapshots held.
+	 */
+	FORCEINLINE int32 Num() const { return Count; }
+
+	/**
+	 * @return The number of snapshots the ring can hold.
+	 */
+	FORCEINLINE int32 GetCapacity() const { return Slots.Num(); }
+
+	/**
+	 * @return The memory allocated by the ring and its snapshots.
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/**
+	 * @return The slot of the Index-th oldest snapshot.
+	 */
+	FORCEINLINE int32 GetSlot(int32 Index) const { return (Head + Index) % Slots.Num(); }
+
+	/** Snapshot slots, the oldest snapshot is at Head. */
+	TArray<FChainSnapshot> Slots;
+
+	/** Slot of the oldest snapshot. */
+	int32 Head = 0;
+
+	/** Number of slots in use. */
+	int32 Count = 0;
+};
@@ -0,0 +1,372 @@
+// This is Sandbox Project.
+
+#include "ChainSolver.h"
+#include "Async/ParallelFor.h"
+
+namespace ChainSolver
+{
+	/** SIMD width of the kernels. */
+	constexpr int32 LaneWidth = 4;
+
+	/**
+	 * Under-relaxation factor of the Jacobi pass, below 1 to damp the summed corrections.
+	 * Interior points receive two corrections per iteration, so the sum is scaled to avoid overshooting.
+	 */
+	constexpr float JacobiRelaxation = 0.75f;
+
+	/**
+	 * Verlet integration of four points along one axis.
+	 * Pinned lanes keep their position, free lanes consume their force.
+	 */
+	FORCEINLINE void IntegrateAxis(float* P, float* O, float* F, float* V, const VectorRegister4Float& Gravity, const VectorRegister4Float& FreeMask)
+	{
+		const VectorRegister4Float Position = VectorLoadAligned(P);
+		const VectorRegister4Float OldPosition = VectorLoadAligned(O);
+		const VectorRegister4Float Force = VectorLoadAligned(F);
+		const VectorRegister4Float Velocity = VectorAdd(VectorSubtract(Position, OldPosition), Gravity);
+
+		VectorStoreAligned(VectorSelect(FreeMask, Position, OldPosition), O);
+		VectorStoreAligned(VectorSelect(FreeMask, VectorSubtract(VectorAdd(Position, Velocity), Force), Position), P);
+		VectorStoreAligned(VectorSelect(FreeMask, Velocity, VectorLoadAligned(V)), V);
+		VectorStoreAligned(VectorSelect(FreeMask, VectorZeroFloat(), Force), F);
+	}
+
+	/**
+	 * Applies the accumulated constraint corrections of four points along one axis.
+	 */
+	FORCEINLINE void ApplyCorrectionAxis(float* P, const float* C, const VectorRegister4Float& Weight)
+	{
+		const VectorRegister4Float Correction = VectorSubtract(VectorLoad(C + 1), VectorLoadAligned(C));
+		VectorStoreAligned(VectorMultiplyAdd(Correction, Weight, VectorLoadAligned(P)), P);
+	}
+
+	/**
+	 * Moves four points toward their follow targets along one axis.
+	 */
+	FORCEINLINE void FollowAxis(float* P, const float* T, const VectorRegister4Float& Weight)
+	{
+		const VectorRegister4Float Position = VectorLoadAligned(P);
+		VectorStoreAligned(VectorMultiplyAdd(VectorSubtract(VectorLoadAligned(T), Position), Weight, Position), P);
+	}
+}
+
+void FChainVectorSolver::Gather(TConstArrayView<FVector> Positions, TConstArrayView<FVector> OldPositions, TConstArrayView<FVector> Forces, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> InPointIndices, float SegmentLength, TConstArrayView<FVector> FollowTargets, TConstArrayView<float> FollowStiffness, TConstArrayView<bool> BrokenConstraints)
+{
+	bFollow = FollowTargets.Num() > 0 && FollowTargets.Num() == FollowStiffness.Num();
+
+	PointIndices.Reset(InPointIndices.Num());
+	PointIndices.Append(InPointIndices.GetData(), InPointIndices.Num());
+	NumPoints = PointIndices.Num();
+	NumAligned = Align(NumPoints, ChainSolver::LaneWidth);
+	Origin = NumPoints > 0 ? Positions[PointIndices[0]] : FVector::ZeroVector;
+
+	// One extra SIMD register of padding for the neighbour loads of the constraint pass.
+	const int32 NumLanes = NumAligned + ChainSolver::LaneWidth;
+
+	for (FLaneArray* Lane : {&PX, &PY, &PZ, &OX, &OY, &OZ, &FX, &FY, &FZ, &VX, &VY, &VZ, &InvMass, &ConstraintMask, &RestLengths, &CX, &CY, &CZ})
+	{
+		Lane->Reset(NumLanes);
+		Lane->AddZeroed(NumLanes);
+	}
+
+	if (bFollow)
+	{
+		for (FLaneArray* Lane : {&TX, &TY, &TZ, &FollowWeight})
+		{
+			Lane->Reset(NumLanes);
+			Lane->AddZeroed(NumLanes);
+		}
+	}
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const int32 Index = PointIndices[i];
+		const FVector Position = Positions[Index] - Origin;
+		const FVector OldPosition = OldPositions[Index] - Origin;
+
+		PX[i] = Position.X;
+		PY[i] = Position.Y;
+		PZ[i] = Position.Z;
+		OX[i] = OldPosition.X;
+		OY[i] = OldPosition.Y;
+		OZ[i] = OldPosition.Z;
+		FX[i] = Forces[Index].X;
+		FY[i] = Forces[Index].Y;
+		FZ[i] = Forces[Index].Z;
+		InvMass[i] = FreeFlags[Index] ? 1.0f : 0.0f;
+
+		if (i < NumPoints - 1)
+		{
+			ConstraintMask[i] = BrokenConstraints.Num() > 0 && BrokenConstraints[i] ? 0.0f : 1.0f;
+			RestLengths[i] = SegmentLength * (PointIndices[i + 1] - Index);
+		}
+
+		if (bFollow)
+		{
+			const FVector Target = FollowTargets[Index] - Origin;
+
+			TX[i] = Target.X;
+			TY[i] = Target.Y;
+			TZ[i] = Target.Z;
+			FollowWeight[i] = InvMass[i] * FollowStiffness[Index];
+		}
+	}
+}
+
+void FChainVectorSolver::Integrate(const FVector& GravityStep)
+{
+	const VectorRegister4Float GravityX = VectorSetFloat1(GravityStep.X);
+	const VectorRegister4Float GravityY = VectorSetFloat1(GravityStep.Y);
+	const VectorRegister4Float GravityZ = VectorSetFloat1(GravityStep.Z);
+
+	for (int32 i = 0; i < NumAligned; i += ChainSolver::LaneWidth)
+	{
+		const VectorRegister4Float FreeMask = VectorCompareGT(VectorLoadAligned(InvMass.GetData() + i), VectorZeroFloat());
+
+		ChainSolver::IntegrateAxis(PX.GetData() + i, OX.GetData() + i, FX.GetData() + i, VX.GetData() + i, GravityX, FreeMask);
+		ChainSolver::IntegrateAxis(PY.GetData() + i, OY.GetData() + i, FY.GetData() + i, VY.GetData() + i, GravityY, FreeMask);
+		ChainSolver::IntegrateAxis(PZ.GetData() + i, OZ.GetData() + i, FZ.GetData() + i, VZ.GetData() + i, GravityZ, FreeMask);
+	}
+}
+
+void FChainVectorSolver::SolveDistance(int32 Iterations)
+{
+	const VectorRegister4Float Relaxation = VectorSetFloat1(ChainSolver::JacobiRelaxation);
+	const VectorRegister4Float Epsilon = VectorSetFloat1(UE_KINDA_SMALL_NUMBER);
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float Zero = VectorZeroFloat();
+
+	for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		// Constraint i links point i and point i + 1, its correction is stored at lane i + 1.
+		for (int32 i = 0; i < NumAligned; i += ChainSolver::LaneWidth)
+		{
+			const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(PX.GetData() + i + 1), VectorLoadAligned(PX.GetData() + i));
+			const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(PY.GetData() + i + 1), VectorLoadAligned(PY.GetData() + i));
+			const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(PZ.GetData() + i + 1), VectorLoadAligned(PZ.GetData() + i));
+
+			const VectorRegister4Float LengthSquared = VectorMultiplyAdd(DeltaZ, DeltaZ, VectorMultiplyAdd(DeltaY, DeltaY, VectorMultiply(DeltaX, DeltaX)));
+			const VectorRegister4Float WeightSum = VectorAdd(VectorLoadAligned(InvMass.GetData() + i), VectorLoad(InvMass.GetData() + i + 1));
+			const VectorRegister4Float ValidMask = VectorBitwiseAnd(VectorCompareGT(LengthSquared, Epsilon), VectorCompareGT(WeightSum, Zero));
+
+			const VectorRegister4Float InvLength = VectorReciprocalSqrt(VectorMax(LengthSquared, Epsilon));
+			const VectorRegister4Float Stretch = VectorNegateMultiplyAdd(VectorLoadAligned(RestLengths.GetData() + i), InvLength, One);
+			const VectorRegister4Float Scale = VectorMultiply(VectorDivide(Stretch, VectorMax(WeightSum, Epsilon)), VectorLoadAligned(ConstraintMask.GetData() + i));
+			const VectorRegister4Float MaskedScale = VectorSelect(ValidMask, Scale, Zero);
+
+			VectorStore(VectorMultiply(DeltaX, MaskedScale), CX.GetData() + i + 1);
+			VectorStore(VectorMultiply(DeltaY, MaskedScale), CY.GetData() + i + 1);
+			VectorStore(VectorMultiply(DeltaZ, MaskedScale), CZ.GetData() + i + 1);
+		}
+
+		// Point i is the start of constraint i and the end of constraint i - 1.
+		for (int32 i = 0; i < NumAligned; i += ChainSolver::LaneWidth)
+		{
+			const VectorRegister4Float Weight = VectorMultiply(VectorLoadAligned(InvMass.GetData() + i), Relaxation);
+
+			ChainSolver::ApplyCorrectionAxis(PX.GetData() + i, CX.GetData() + i, Weight);
+			ChainSolver::ApplyCorrectionAxis(PY.GetData() + i, CY.GetData() + i, Weight);
+			ChainSolver::ApplyCorrectionAxis(PZ.GetData() + i, CZ.GetData() + i, Weight);
+
+			if (bFollow)
+			{
+				const VectorRegister4Float Follow = VectorLoadAligned(FollowWeight.GetData() + i);
+
+				ChainSolver::FollowAxis(PX.GetData() + i, TX.GetData() + i, Follow);
+				ChainSolver::FollowAxis(PY.GetData() + i, TY.GetData() + i, Follow);
+				ChainSolver::FollowAxis(PZ.GetData() + i, TZ.GetData() + i, Follow);
+			}
+		}
+	}
+}
+
+void FChainVectorSolver::Scatter(TArrayView<FVector> Positions, TArrayView<FVector> OldPositions, TArrayView<FVector> Forces, TArrayView<FVector> Velocities, TConstArrayView<bool> FreeFlags) const
+{
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const int32 Index = PointIndices[i];
+
+		// Pinned points are never moved by the solver, skip them to avoid the float round trip.
+		if (! FreeFlags[Index]) continue;
+
+		Positions[Index] = Origin + FVector(PX[i], PY[i], PZ[i]);
+		OldPositions[Index] = Origin + FVector(OX[i], OY[i], OZ[i]);
+		Velocities[Index] = FVector(VX[i], VY[i], VZ[i]);
+		Forces[Index] = FVector::ZeroVector;
+	}
+}
+
+FChainXPBDSolver::FResult FChainXPBDSolver::Solve(TArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, float SegmentLength, const FChainXPBDSettings& Settings, TConstArrayView<FVector> FollowTargets, TConstArrayView<float> FollowStiffness, TConstArrayView<bool> BrokenConstraints)
+{
+	FResult Result;
+
+	const int32 NumConstraints = PointIndices.Num() - 1;
+	if (NumConstraints <= 0) return Result;
+
+	Lambdas.Reset(NumConstraints);
+	Lambdas.AddZeroed(NumConstraints);
+	RestLengths.SetNumUninitialized(NumConstraints, EAllowShrinking::No);
+
+	for (int32 Constraint = 0; Constraint < NumConstraints; Constraint++)
+	{
+		const bool bBroken = BrokenConstraints.Num() > 0 && BrokenConstraints[Constraint];
+		RestLengths[Constraint] = bBroken ? -1.0f : SegmentLength * (PointIndices[Constraint + 1] - PointIndices[Constraint]);
+	}
+
+	const float AlphaTilde = Settings.Compliance / FMath::Square(FMath::Max(Settings.TimeStep, UE_KINDA_SMALL_NUMBER));
+
+	// A color holds half of the constraints, it is only split if that yields at least two batches.
+	const bool bParallel = Settings.bRedBlack && Settings.ParallelBatchSize > 0 && NumConstraints >= 4 * Settings.ParallelBatchSize;
+	const int32 BatchSize = bParallel ? Settings.ParallelBatchSize : NumConstraints;
+
+	for (int32 Iteration = 0; Iteration < Settings.Iterations; Iteration++)
+	{
+		float Residual = 0.0f;
+
+		if (Settings.bRedBlack)
+		{
+			Residual = SolveColor(Positions, FreeFlags, PointIndices, 0, AlphaTilde, BatchSize);
+			Residual = FMath::Max(Residual, SolveColor(Positions, FreeFlags, PointIndices, 1, AlphaTilde, BatchSize));
+		}
+		else
+		{
+			for (int32 Constraint = 0; Constraint < NumConstraints; Constraint++)
+			{
+				Residual = FMath::Max(Residual, SolveConstraint(Positions, FreeFlags, PointIndices, Constraint, AlphaTilde));
+			}
+		}
+
+		// The follow pull is not part of the residual, it only fights the distance constraints where the target is out of reach.
+		if (FollowTargets.Num() > 0)
+		{
+			ChainSolver::SolveFollow(Positions, FreeFlags, PointIndices, FollowTargets, FollowStiffness);
+		}
+
+		Result.Iterations++;
+		Result.Residual = Residual;
+
+		if (Residual <= Settings.Tolerance) break;
+	}
+
+	return Result;
+}
+
+float FChainXPBDSolver::SolveColor(TArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, int32 Color, float AlphaTilde, int32 BatchSize)
+{
+	const int32 NumConstraints = PointIndices.Num() - 1;
+	const int32 NumColorConstraints = (NumConstraints - Color + 1) / 2;
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumColorConstraints, FMath::Max(BatchSize, 1));
+
+	BatchResiduals.Reset(NumBatches);
+	BatchResiduals.AddZeroed(NumBatches);
+
+	// Constraint Color + 2 * k only touches its own two points, so batches never write the same point.
+	ParallelFor(NumBatches, [&](int32 Batch)
+	{
+		const int32 First = Batch * BatchSize;
+		const int32 Last = FMath::Min(First + BatchSize, NumColorConstraints);
+		float Residual = 0.0f;
+
+		for (int32 k = First; k < Last; k++)
+		{
+			Residual = FMath::Max(Residual, SolveConstraint(Positions, FreeFlags, PointIndices, Color + 2 * k, AlphaTilde));
+		}
+
+		BatchResiduals[Batch] = Residual;
+	}, NumBatches > 1 ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	float Residual = 0.0f;
+	for (const float BatchResidual : BatchResiduals)
+	{
+		Residual = FMath::Max(Residual, BatchResidual);
+	}
+
+	return Residual;
+}
+
+float FChainXPBDSolver::SolveConstraint(TArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, int32 Constraint, float AlphaTilde)
+{
+	const float RestLength = RestLengths[Constraint];
+	if (RestLength < 0.0f) return 0.0f;
+
+	const int32 A = PointIndices[Constraint];
+	const int32 B = PointIndices[Constraint + 1];
+	const float WeightA = FreeFlags[A] ? 1.0f : 0.0f;
+	const float WeightB = FreeFlags[B] ? 1.0f : 0.0f;
+
+	const FVector Delta = Positions[B] - Positions[A];
+	const float Length = Delta.Size();
+	if (WeightA + WeightB <= 0.0f || Length <= UE_KINDA_SMALL_NUMBER) return 0.0f;
+
+	const float Stretch = Length - RestLength;
+	const float DeltaLambda = (-Stretch - AlphaTilde * Lambdas[Constraint]) / (WeightA + WeightB + AlphaTilde);
+	Lambdas[Constraint] += DeltaLambda;
+
+	const FVector Correction = (DeltaLambda / Length) * Delta;
+	Positions[A] -= WeightA * Correction;
+	Positions[B] += WeightB * Correction;
+
+	return FMath::Abs(Stretch) / FMath::Max(RestLength, UE_KINDA_SMALL_NUMBER);
+}
+
+float ChainSolver::MeasureResidual(TConstArrayView<FVector> Positions, TConstArrayView<int32> PointIndices, float SegmentLength, TConstArrayView<bool> BrokenConstraints)
+{
+	float Residual = 0.0f;
+
+	for (int32 Constraint = 0; Constraint < PointIndices.Num() - 1; Constraint++)
+	{
+		if (BrokenConstraints.Num() > 0 && BrokenConstraints[Constraint]) continue;
+
+		const int32 A = PointIndices[Constraint];
+		const int32 B = PointIndices[Constraint + 1];
+		const float RestLength = SegmentLength * (B - A);
+
+		Residual = FMath::Max(Residual, FMath::Abs(FVector::Dist(Positions[A], Positions[B]) - RestLength) / FMath::Max(RestLength, UE_KINDA_SMALL_NUMBER));
+	}
+
+	return Residual;
+}
+
+int32 ChainSolver::FindMostStretched(TConstArrayView<FVector> Positions, TConstArrayView<int32> PointIndices, float SegmentLength, TConstArrayView<bool> BrokenConstraints, float& OutStretch)
+{
+	int32 MostStretched = INDEX_NONE;
+	OutStretch = 0.0f;
+
+	for (int32 Constraint = 0; Constraint < PointIndices.Num() - 1; Constraint++)
+	{
+		if (BrokenConstraints.Num() > 0 && BrokenConstraints[Constraint]) continue;
+
+		const int32 A = PointIndices[Constraint];
+		const int32 B = PointIndices[Constraint + 1];
+		const float RestLength = SegmentLength * (B - A);
+		const float Stretch = (FVector::Dist(Positions[A], Positions[B]) - RestLength) / FMath::Max(RestLength, UE_KINDA_SMALL_NUMBER);
+
+		if (MostStretched == INDEX_NONE || Stretch > OutStretch)
+		{
+			MostStretched = Constraint;
+			OutStretch = Stretch;
+		}
+	}
+
+	return MostStretched;
+}
+
+float ChainSolver::GetIterationStiffness(float Stiffness, int32 Iterations)
+{
+	const float ClampedStiffness = FMath::Clamp(Stiffness, 0.0f, 1.0f);
+	if (ClampedStiffness <= 0.0f || ClampedStiffness >= 1.0f || Iterations <= 1) return ClampedStiffness;
+
+	// Closing a fraction s in each of n iterations leaves (1 - s)^n of the distance.
+	return 1.0f - FMath::Pow(1.0f - ClampedStiffness, 1.0f / Iterations);
+}
+
+void ChainSolver::SolveFollow(TArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, TConstArrayView<FVector> Targets, TConstArrayView<float> Stiffness)
+{
+	for (const int32 Index : PointIndices)
+	{
+		if (FreeFlags[Index] && Stiffness[Index] > 0.0f)
+		{
+			Positions[Index] += (Targets[Index] - Positions[Index]) * Stiffness[Index];
+		}
+	}
+}
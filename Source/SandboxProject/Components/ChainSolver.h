@@ -0,0 +1,223 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/VectorRegister.h"
+
+/**
+ * SIMD implementation of the chain Verlet step.
+ *
+ * The solver keeps its own lane buffers (one float array per axis) so that every kernel
+ * processes four points per instruction. Pinned points are handled with an inverse mass
+ * of zero, so the kernels contain no per point branches.
+ *
+ * Distance constraints are solved Jacobi style: every constraint correction of an iteration is
+ * computed from the same positions and applied in a second pass, which makes the constraint pass
+ * vectorizable at the cost of a slightly slower convergence than the scalar Gauss-Seidel loop.
+ *
+ * Positions are stored relative to the first gathered point to keep float precision in large worlds.
+ *
+ * Optional follow targets pull every free point toward a target location within the same constraint pass.
+ */
+struct SANDBOXPROJECT_API FChainVectorSolver
+{
+	/**
+	 * Copies the simulated subset of the component buffers into the solver lanes.
+	 *
+	 * @param Positions Current positions of the chain points.
+	 * @param OldPositions Positions of the previous simulation step.
+	 * @param Forces External forces accumulated on the chain points.
+	 * @param FreeFlags Whether each point is free or pinned.
+	 * @param PointIndices Ascending indices of the simulated points, consecutive entries are linked by a constraint.
+	 * @param SegmentLength Rest length between two neighbouring chain points.
+	 * @param FollowTargets Location each point is pulled toward, empty for no follow targets.
+	 * @param FollowStiffness Fraction of the distance to its target each point closes per iteration.
+	 * @param BrokenConstraints Whether each constraint between consecutive PointIndices is broken, empty if none is.
+	 */
+	void Gather(TConstArrayView<FVector> Positions, TConstArrayView<FVector> OldPositions, TConstArrayView<FVector> Forces, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, float SegmentLength, TConstArrayView<FVector> FollowTargets = {}, TConstArrayView<float> FollowStiffness = {}, TConstArrayView<bool> BrokenConstraints = {});
+
+	/**
+	 * Verlet integration of the free points, consuming the accumulated forces.
+	 *
+	 * @param GravityStep Displacement applied by gravity in one step.
+	 */
+	void Integrate(const FVector& GravityStep);
+
+	/**
+	 * Projects all points onto their distance constraints, and toward their follow targets if gathered.
+	 *
+	 * @param Iterations The number of Jacobi iterations.
+	 */
+	void SolveDistance(int32 Iterations);
+
+	/**
+	 * Copies the solver lanes back into the gathered points of the component buffers.
+	 * Forces of free points are cleared, velocities are only written for free points.
+	 */
+	void Scatter(TArrayView<FVector> Positions, TArrayView<FVector> OldPositions, TArrayView<FVector> Forces, TArrayView<FVector> Velocities, TConstArrayView<bool> FreeFlags) const;
+
+	/**
+	 * @return The number of points currently held by the solver.
+	 */
+	FORCEINLINE int32 Num() const { return NumPoints; }
+
+private:
+	using FLaneArray = TArray<float, TAlignedHeapAllocator<16>>;
+
+	/** Number of real chain points. */
+	int32 NumPoints = 0;
+
+	/** Number of points rounded up to the SIMD width. */
+	int32 NumAligned = 0;
+
+	/** World space origin the lanes are relative to. */
+	FVector Origin = FVector::ZeroVector;
+
+	/** Component buffer index of each solver point. */
+	TArray<int32> PointIndices;
+
+	FLaneArray PX, PY, PZ;
+	FLaneArray OX, OY, OZ;
+	FLaneArray FX, FY, FZ;
+	FLaneArray VX, VY, VZ;
+
+	/** Inverse mass of each point, 1 for free points and 0 for pinned and padding points. */
+	FLaneArray InvMass;
+
+	/** 1 for every intact constraint between two real points, 0 for broken constraints and padding. */
+	FLaneArray ConstraintMask;
+
+	/** Rest length of each constraint, longer than a segment when points are skipped. */
+	FLaneArray RestLengths;
+
+	/** Per constraint correction, offset by one lane so that CX[i] holds the correction of constraint i - 1. */
+	FLaneArray CX, CY, CZ;
+
+	/** Follow target of each point. */
+	FLaneArray TX, TY, TZ;
+
+	/** Follow stiffness of each point per iteration, 0 for pinned and padding points. */
+	FLaneArray FollowWeight;
+
+	/** Whether follow targets were gathered. */
+	bool bFollow = false;
+};
+
+/**
+ * Parameters of one FChainXPBDSolver solve.
+ */
+struct FChainXPBDSettings
+{
+	/** Maximal number of iterations. */
+	int32 Iterations = 1;
+
+	/** Inverse stiffness of the segments, 0 makes them inextensible. */
+	float Compliance = 0.0f;
+
+	/** Duration of the simulated step in seconds. */
+	float TimeStep = 1.0f / 60.0f;
+
+	/** Relative stretch below which the solver stops iterating, 0 always runs every iteration. */
+	float Tolerance = 0.0f;
+
+	/** Solve the even constraints first and the odd constraints second, instead of in chain order. */
+	bool bRedBlack = false;
+
+	/** Constraints per task when a red-black color is split across threads, 0 never splits. */
+	int32 ParallelBatchSize = 0;
+};
+
+/**
+ * Extended position based dynamics solver of the chain distance constraints.
+ *
+ * Each constraint keeps a Lagrange multiplier over the iterations of a step, so the compliance is
+ * independent of the iteration count and the step time. In red-black order no two constraints of
+ * the same color share a point, which lets the constraints of one color run on several threads.
+ * Works directly on the component buffers, integration is left to the caller.
+ */
+struct SANDBOXPROJECT_API FChainXPBDSolver
+{
+	/**
+	 * Statistics of one solve.
+	 */
+	struct FResult
+	{
+		/** Number of iterations until convergence or the iteration limit. */
+		int32 Iterations = 0;
+
+		/** Largest relative stretch of a constraint seen in the last iteration. */
+		float Residual = 0.0f;
+	};
+
+	/**
+	 * Projects the points onto their distance constraints.
+	 *
+	 * @param Positions Positions of the chain points, integrated by the caller.
+	 * @param FreeFlags Whether each point is free or pinned.
+	 * @param PointIndices Ascending indices of the simulated points, consecutive entries are linked by a constraint.
+	 * @param SegmentLength Rest length between two neighbouring chain points.
+	 * @param Settings Parameters of the solve.
+	 * @param FollowTargets Location each point is pulled toward after every iteration, empty for no follow targets.
+	 * @param FollowStiffness Fraction of the distance to its target each point closes per iteration.
+	 * @param BrokenConstraints Whether each constraint between consecutive PointIndices is broken, empty if none is.
+	 */
+	FResult Solve(TArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, float SegmentLength, const FChainXPBDSettings& Settings, TConstArrayView<FVector> FollowTargets = {}, TConstArrayView<float> FollowStiffness = {}, TConstArrayView<bool> BrokenConstraints = {});
+
+private:
+	/**
+	 * Solves every constraint of one color, on several threads if it has more than one batch.
+	 *
+	 * @return The largest relative stretch of the color.
+	 */
+	float SolveColor(TArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, int32 Color, float AlphaTilde, int32 BatchSize);
+
+	/**
+	 * Projects a single constraint and updates its multiplier.
+	 *
+	 * @return The relative stretch of the constraint before the projection.
+	 */
+	float SolveConstraint(TArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, int32 Constraint, float AlphaTilde);
+
+	/** Lagrange multiplier of each constraint. */
+	TArray<float> Lambdas;
+
+	/** Rest length of each constraint, negative for broken constraints. */
+	TArray<float> RestLengths;
+
+	/** Largest stretch of each batch of a parallel color. */
+	TArray<float> BatchResiduals;
+};
+
+namespace ChainSolver
+{
+	/**
+	 * @param BrokenConstraints Whether each constraint between consecutive PointIndices is broken, empty if none is.
+	 * @return The largest relative stretch over the intact distance constraints between the given points.
+	 */
+	SANDBOXPROJECT_API float MeasureResidual(TConstArrayView<FVector> Positions, TConstArrayView<int32> PointIndices, float SegmentLength, TConstArrayView<bool> BrokenConstraints = {});
+
+	/**
+	 * Finds the most stretched intact distance constraint between the given points.
+	 *
+	 * @param BrokenConstraints Whether each constraint between consecutive PointIndices is broken, empty if none is.
+	 * @param OutStretch Receives the relative stretch of the found constraint.
+	 * @return The index of the constraint in PointIndices, INDEX_NONE if there is no intact constraint.
+	 */
+	SANDBOXPROJECT_API int32 FindMostStretched(TConstArrayView<FVector> Positions, TConstArrayView<int32> PointIndices, float SegmentLength, TConstArrayView<bool> BrokenConstraints, float& OutStretch);
+
+	/**
+	 * Splits a per step stiffness over the iterations of the step, so the pull toward a target does not depend on the iteration count.
+	 *
+	 * @return The fraction of the remaining distance to close in each iteration.
+	 */
+	SANDBOXPROJECT_API float GetIterationStiffness(float Stiffness, int32 Iterations);
+
+	/**
+	 * Moves the free points toward their follow targets, the soft constraint pass of the scalar and XPBD backends.
+	 *
+	 * @param Targets Location each point is pulled toward.
+	 * @param Stiffness Fraction of the distance to its target each point closes.
+	 */
+	SANDBOXPROJECT_API void SolveFollow(TArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, TConstArrayView<int32> PointIndices, TConstArrayView<FVector> Targets, TConstArrayView<float> Stiffness);
+}
@@ -0,0 +1,234 @@
+// This is Sandbox Project.
+
+#include "ChainSpatialHash.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(ChainSpatialHashLog, All, All);
+
+void FChainSpatialHash::Build(TConstArrayView<FVector> Points, float CellSize)
+{
+	const int32 NumPoints = Points.Num();
+	const int32 NumBuckets = FMath::RoundUpToPowerOfTwo(FMath::Max(NumPoints * 2, 16));
+
+	InvCellSize = 1.0f / FMath::Max(CellSize, UE_KINDA_SMALL_NUMBER);
+	BucketMask = static_cast<uint32>(NumBuckets - 1);
+
+	BucketStart.Reset(NumBuckets + 1);
+	BucketStart.AddZeroed(NumBuckets + 1);
+	PointBuckets.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+	SortedIndices.SetNumUninitialized(NumPoints, EAllowShrinking::No);
+
+	// Count the points of each bucket, shifted by one so the prefix sum yields start offsets.
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const uint32 Bucket = HashCell(GetCell(Points[i])) & BucketMask;
+		PointBuckets[i] = Bucket;
+		BucketStart[Bucket + 1]++;
+	}
+
+	for (int32 Bucket = 1; Bucket <= NumBuckets; Bucket++)
+	{
+		BucketStart[Bucket] += BucketStart[Bucket - 1];
+	}
+
+	BucketCursor.Reset(NumBuckets);
+	BucketCursor.Append(BucketStart.GetData(), NumBuckets);
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		SortedIndices[BucketCursor[PointBuckets[i]]++] = i;
+	}
+}
+
+void FChainCollisionWorld::Reset()
+{
+	Chains.Reset();
+	Points.Reset();
+	PointChains.Reset();
+	MaxRadius = 0.0f;
+}
+
+int32 FChainCollisionWorld::AddChain(TConstArrayView<FVector> Positions, float Radius, int32 Groups, int32 Mask, bool bDynamic)
+{
+	const int32 ChainIndex = Chains.Num();
+
+	FChainEntry& Entry = Chains.AddDefaulted_GetRef();
+	Entry.FirstPoint = Points.Num();
+	Entry.Radius = Radius;
+	Entry.Groups = Groups;
+	Entry.Mask = Mask;
+	Entry.bDynamic = bDynamic;
+
+	Points.Append(Positions.GetData(), Positions.Num());
+	PointChains.AddUninitialized(Positions.Num());
+
+	for (int32 i = Entry.FirstPoint; i < Points.Num(); i++)
+	{
+		PointChains[i] = ChainIndex;
+	}
+
+	MaxRadius = FMath::Max(MaxRadius, Radius);
+
+	return ChainIndex;
+}
+
+void FChainCollisionWorld::Build()
+{
+	// Cells as large as the largest contact distance keep every contact within the 27 queried cells.
+	// Tiny radii would make cells so small that world space cell coordinates overflow, 1 cm is the lower bound.
+	Hash.Build(Points, FMath::Max(MaxRadius * 2.0f, 1.0f));
+}
+
+int32 FChainCollisionWorld::Resolve(int32 ChainIndex, TConstArrayView<int32> SimulatedIndices, TConstArrayView<bool> FreeFlags, int32 Budget, TArrayView<FVector> Forces, int32& Cursor) const
+{
+	const FChainEntry& Chain = Chains[ChainIndex];
+	const int32 NumSimulated = SimulatedIndices.Num();
+	if (NumSimulated == 0) return 0;
+
+	const int32 StartPoint = Cursor % NumSimulated;
+	int32 NumTests = 0;
+	int32 Offset = 0;
+
+	for (; Offset < NumSimulated && NumTests < Budget; Offset++)
+	{
+		const int32 i = SimulatedIndices[(StartPoint + Offset) % NumSimulated];
+		if (! FreeFlags[i]) continue;
+
+		const FVector& Point = Points[Chain.FirstPoint + i];
+
+		Hash.ForEachCandidate(Point, [&](int32 j)
+		{
+			// Every visited candidate counts against the budget, including own and masked out points.
+			NumTests++;
+
+			const int32 OtherIndex = PointChains[j];
+			if (OtherIndex == ChainIndex) return;
+
+			const FChainEntry& Other = Chains[OtherIndex];
+			if ((Chain.Groups & Other.Mask) == 0 || (Other.Groups & Chain.Mask) == 0) return;
+
+			const FVector Delta = Point - Points[j];
+			const double Contact = Chain.Radius + Other.Radius;
+			const double DistanceSquared = Delta.SizeSquared();
+			if (DistanceSquared >= FMath::Square(Contact) || DistanceSquared < UE_SMALL_NUMBER) return;
+
+			// Both chains push themselves apart by half the penetration, a static chain does not move at all.
+			const double Distance = FMath::Sqrt(DistanceSquared);
+			const double Share = Other.bDynamic ? 0.5 : 1.0;
+
+			Forces[i] -= Delta * ((Contact - Distance) / Distance * Share);
+		});
+	}
+
+	Cursor = (StartPoint + Offset) % NumSimulated;
+
+	return NumTests;
+}
+
+namespace ChainCollision
+{
+	/**
+	 * Accumulates the self collision force between point i and point j, if they are close enough.
+	 */
+	FORCEINLINE void AccumulatePair(TConstArrayView<FVector> Positions, int32 i, int32 j, float Width, float Threshold, TArrayView<FVector> Forces)
+	{
+		// Direct neighbours are always closer than the self collision width.
+		if (FMath::Abs(j - i) <= 2) return;
+
+		const float Distance = FVector::Dist(Positions[i], Positions[j]);
+
+		if (Distance < Width)
+		{
+			FVector Normal = Positions[i] - Positions[j];
+			Normal *= ((Normal.Size() - Width) / Width);
+
+			if (! Normal.IsNearlyZero(Threshold))
+			{
+				Forces[i] += Normal;
+			}
+		}
+	}
+
+	void AccumulateSelfCollisionBruteForce(TConstArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, float Width, float Threshold, TArrayView<FVector> Forces)
+	{
+		for (int32 i = 0; i < Positions.Num(); i++)
+		{
+			if (! FreeFlags[i]) continue;
+
+			for (int32 j = 0; j < Positions.Num(); j++)
+			{
+				AccumulatePair(Positions, i, j, Width, Threshold, Forces);
+			}
+		}
+	}
+
+	void AccumulateSelfCollisionHashed(TConstArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, float Width, float Threshold, TArrayView<FVector> Forces, FChainSpatialHash& Hash)
+	{
+		Hash.Build(Positions, Width);
+
+		for (int32 i = 0; i < Positions.Num(); i++)
+		{
+			if (! FreeFlags[i]) continue;
+
+			Hash.ForEachCandidate(Positions[i], [&](int32 j) { AccumulatePair(Positions, i, j, Width, Threshold, Forces); });
+		}
+	}
+
+	/**
+	 * Compares both self collision paths on a tightly coiled chain for segment counts 16 to 1024.
+	 * Usage: Chain.BenchmarkSelfCollision [Iterations]
+	 */
+	static void BenchmarkSelfCollision(const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+		constexpr float Width = 20.0f;
+		constexpr float Threshold = 0.05f;
+
+		UE_LOG(ChainSpatialHashLog, Display, TEXT("Segments, BruteForceMs, HashedMs, Speedup, MaxForceError"));
+
+		FChainSpatialHash Hash;
+
+		for (int32 Segments = 16; Segments <= 1024; Segments *= 2)
+		{
+			TArray<FVector> Positions;
+			TArray<bool> FreeFlags;
+			Positions.SetNumUninitialized(Segments);
+			FreeFlags.Init(true, Segments);
+
+			// Helix with a pitch below the collision width, so every coil touches its neighbours.
+			for (int32 i = 0; i < Segments; i++)
+			{
+				const float Angle = i * 0.35f;
+				Positions[i] = FVector(FMath::Cos(Angle) * Width * 3.0f, FMath::Sin(Angle) * Width * 3.0f, i * Width * 0.02f);
+			}
+
+			TArray<FVector> BruteForces, HashedForces;
+			BruteForces.SetNumZeroed(Segments);
+			HashedForces.SetNumZeroed(Segments);
+
+			double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				AccumulateSelfCollisionBruteForce(Positions, FreeFlags, Width, Threshold, BruteForces);
+			}
+			const double BruteMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+			{
+				AccumulateSelfCollisionHashed(Positions, FreeFlags, Width, Threshold, HashedForces, Hash);
+			}
+			const double HashedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+
+			double MaxError = 0.0;
+			for (int32 i = 0; i < Segments; i++)
+			{
+				MaxError = FMath::Max(MaxError, (BruteForces[i] - HashedForces[i]).Size() / Iterations);
+			}
+
+			UE_LOG(ChainSpatialHashLog, Display, TEXT("%d, %.4f, %.4f, %.2fx, %g"), Segments, BruteMs, HashedMs, BruteMs / FMath::Max(HashedMs, UE_SMALL_NUMBER), MaxError);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkSelfCollisionCommand(TEXT("Chain.BenchmarkSelfCollision"), TEXT("Compares brute force and spatial hash chain self collision for 16 to 1024 segments. Usage: Chain.BenchmarkSelfCollision [Iterations]"), FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkSelfCollision));
+}
@@ -0,0 +1,193 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform grid broadphase over a set of points, hashed into a fixed size bucket table.
+ *
+ * Points are bucketed with a counting sort into flat arrays that keep their capacity between builds,
+ * so rebuilding the grid every simulation step does not allocate once the arena has grown.
+ * Different cells may share a bucket, callers are expected to run their own exact distance test.
+ */
+struct SANDBOXPROJECT_API FChainSpatialHash
+{
+	/**
+	 * Rebuilds the grid from the given points.
+	 *
+	 * @param Points The points to insert, indices passed to the queries refer to this view.
+	 * @param CellSize The edge length of a grid cell, usually the query radius.
+	 */
+	void Build(TConstArrayView<FVector> Points, float CellSize);
+
+	/**
+	 * Calls the functor with the index of every point in the 27 cells around the given location.
+	 * Each point is visited at most once, even if several of the cells share a bucket.
+	 *
+	 * @param Location The center of the query.
+	 * @param Functor Callable taking the int32 index of a candidate point.
+	 */
+	template <typename FunctorType>
+	void ForEachCandidate(const FVector& Location, FunctorType&& Functor) const
+	{
+		if (SortedIndices.Num() == 0) return;
+
+		const FIntVector Cell = GetCell(Location);
+		TArray<uint32, TInlineAllocator<27>> Buckets;
+
+		for (int32 X = -1; X <= 1; X++)
+		{
+			for (int32 Y = -1; Y <= 1; Y++)
+			{
+				for (int32 Z = -1; Z <= 1; Z++)
+				{
+					Buckets.AddUnique(HashCell(Cell + FIntVector(X, Y, Z)) & BucketMask);
+				}
+			}
+		}
+
+		for (const uint32 Bucket : Buckets)
+		{
+			for (int32 Entry = BucketStart[Bucket]; Entry < BucketStart[Bucket + 1]; Entry++)
+			{
+				Functor(SortedIndices[Entry]);
+			}
+		}
+	}
+
+private:
+	/**
+	 * @return The grid cell containing the location.
+	 */
+	FORCEINLINE FIntVector GetCell(const FVector& Location) const
+	{
+		return FIntVector(FMath::FloorToInt32(Location.X * InvCellSize), FMath::FloorToInt32(Location.Y * InvCellSize), FMath::FloorToInt32(Location.Z * InvCellSize));
+	}
+
+	/**
+	 * @return The unmasked hash of a grid cell.
+	 */
+	static FORCEINLINE uint32 HashCell(const FIntVector& Cell)
+	{
+		return (static_cast<uint32>(Cell.X) * 73856093u) ^ (static_cast<uint32>(Cell.Y) * 19349663u) ^ (static_cast<uint32>(Cell.Z) * 83492791u);
+	}
+
+	/** Inverse of the cell edge length. */
+	float InvCellSize = 1.0f;
+
+	/** Bucket count minus one, the bucket count is a power of two. */
+	uint32 BucketMask = 0;
+
+	/** Offset of the first entry of each bucket in SortedIndices, with one trailing end offset. */
+	TArray<int32> BucketStart;
+
+	/** Write cursor of each bucket while building. */
+	TArray<int32> BucketCursor;
+
+	/** Bucket of each point while building. */
+	TArray<uint32> PointBuckets;
+
+	/** Point indices sorted by bucket. */
+	TArray<int32> SortedIndices;
+};
+
+/**
+ * Points of every chain taking part in chain to chain collision, in one spatial hash built once per step.
+ *
+ * Each chain is added with its collision group and mask, then every stepping chain queries the shared
+ * hash for the points of other chains around its own points. This replaces pairwise tests between all
+ * chains and scene queries against the chain bodies. Queries only read the world, so chains can resolve
+ * against it in parallel.
+ */
+struct SANDBOXPROJECT_API FChainCollisionWorld
+{
+	/**
+	 * Removes every chain, keeps the arena.
+	 */
+	void Reset();
+
+	/**
+	 * Adds the points of a chain.
+	 *
+	 * @param Positions Positions of the chain points.
+	 * @param Radius The collision radius of every point.
+	 * @param Groups Bitmask of the collision groups the chain belongs to.
+	 * @param Mask Bitmask of the collision groups the chain collides with.
+	 * @param bDynamic Whether the chain steps this frame and takes half of each correction, static chains take none.
+	 * @return The index of the chain in the world.
+	 */
+	int32 AddChain(TConstArrayView<FVector> Positions, float Radius, int32 Groups, int32 Mask, bool bDynamic);
+
+	/**
+	 * Rebuilds the spatial hash from the added chains.
+	 */
+	void Build();
+
+	/**
+	 * Accumulates the push apart displacement between the free points of a chain and the points of other chains.
+	 * Points are visited from Cursor and wrap around, so a budget that runs out does not always skip the same points.
+	 *
+	 * @param ChainIndex The index returned by AddChain.
+	 * @param SimulatedIndices The points of the chain to test.
+	 * @param FreeFlags Whether each point is free or pinned.
+	 * @param Budget Maximal number of hash candidates visited, including the chain's own and masked out points. Checked before each point.
+	 * @param Forces The forces of the chain points.
+	 * @param Cursor Position in SimulatedIndices of the first tested point, moved past the last tested point.
+	 * @return The number of hash candidates visited.
+	 */
+	int32 Resolve(int32 ChainIndex, TConstArrayView<int32> SimulatedIndices, TConstArrayView<bool> FreeFlags, int32 Budget, TArrayView<FVector> Forces, int32& Cursor) const;
+
+	/**
+	 * @return The number of chains in the world.
+	 */
+	FORCEINLINE int32 GetNumChains() const { return Chains.Num(); }
+
+private:
+	/** A chain added to the world. */
+	struct FChainEntry
+	{
+		int32 FirstPoint = 0;
+		float Radius = 0.0f;
+		int32 Groups = 0;
+		int32 Mask = 0;
+		bool bDynamic = false;
+	};
+
+	/** Added chains. */
+	TArray<FChainEntry> Chains;
+
+	/** Positions of the points of every chain, chain after chain. */
+	TArray<FVector> Points;
+
+	/** Chain of each point. */
+	TArray<int32> PointChains;
+
+	/** Largest collision radius of any chain. */
+	float MaxRadius = 0.0f;
+
+	/** Broadphase over Points, keyed on the largest contact distance. */
+	FChainSpatialHash Hash;
+};
+
+namespace ChainCollision
+{
+	/**
+	 * Reference self collision, tests every free point against every other point of the chain.
+	 * Accumulates the push apart force of each colliding point into Forces.
+	 *
+	 * @param Positions Positions of the chain points.
+	 * @param FreeFlags Whether each point is free or pinned.
+	 * @param Width The self collision width.
+	 * @param Threshold Minimal force that is applied.
+	 * @param Forces The forces of the chain points.
+	 */
+	SANDBOXPROJECT_API void AccumulateSelfCollisionBruteForce(TConstArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, float Width, float Threshold, TArrayView<FVector> Forces);
+
+	/**
+	 * Same result as AccumulateSelfCollisionBruteForce, with the candidate pairs taken from a spatial hash.
+	 *
+	 * @param Hash Grid rebuilt from the positions, its arena is reused between calls.
+	 */
+	SANDBOXPROJECT_API void AccumulateSelfCollisionHashed(TConstArrayView<FVector> Positions, TConstArrayView<bool> FreeFlags, float Width, float Threshold, TArrayView<FVector> Forces, FChainSpatialHash& Hash);
+}
@@ -0,0 +1,48 @@
+// This is Sandbox Project.
+
+#include "ChainStats.h"
+
+DEFINE_STAT(STAT_ChainPreSimulate);
+DEFINE_STAT(STAT_ChainSimulate);
+DEFINE_STAT(STAT_ChainPostSimulate);
+DEFINE_STAT(STAT_ChainSubsystemTick);
+DEFINE_STAT(STAT_ChainToChainCollision);
+DEFINE_STAT(STAT_ChainUpdateMeshes);
+
+DEFINE_STAT(STAT_ChainSimulatedChains);
+DEFINE_STAT(STAT_ChainInstancesUploaded);
+DEFINE_STAT(STAT_ChainSleepingChains);
+DEFINE_STAT(STAT_ChainSubsteps);
+DEFINE_STAT(STAT_ChainSolverIterations);
+DEFINE_STAT(STAT_ChainCollisionPairs);
+DEFINE_STAT(STAT_ChainReplicatedKeyframes);
+DEFINE_STAT(STAT_ChainDispatchedEvents);
+DEFINE_STAT(STAT_ChainSolverResidual);
+
+void FChainPhaseTimings::Accumulate(const FChainPhaseTimings& Other)
+{
+	for (int32 Phase = 0; Phase < static_cast<int32>(EChainPhase::Num); Phase++)
+	{
+		Cycles[Phase] += Other.Cycles[Phase];
+	}
+}
+
+double FChainPhaseTimings::GetMilliseconds(EChainPhase Phase) const
+{
+	return FPlatformTime::ToMilliseconds64(Cycles[static_cast<int32>(Phase)]);
+}
+
+const TCHAR* FChainPhaseTimings::GetPhaseName(EChainPhase Phase)
+{
+	switch (Phase)
+	{
+		case EChainPhase::Pins: return TEXT("Pins");
+		case EChainPhase::Gravity: return TEXT("Gravity");
+		case EChainPhase::Constraints: return TEXT("Constraints");
+		case EChainPhase::Collision: return TEXT("Collision");
+		case EChainPhase::Events: return TEXT("Events");
+		case EChainPhase::Meshes: return TEXT("Meshes");
+		case EChainPhase::Attachments: return TEXT("Attachments");
+		default: return TEXT("Unknown");
+	}
+}
@@ -0,0 +1,103 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Chain"), STATGROUP_Chain, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chain Pre Simulate"), STAT_ChainPreSimulate, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chain Simulate"), STAT_ChainSimulate, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chain Post Simulate"), STAT_ChainPostSimulate, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chain Subsystem Tick"), STAT_ChainSubsystemTick, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chain To Chain Collision"), STAT_ChainToChainCollision, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chain Update Meshes"), STAT_ChainUpdateMeshes, STATGROUP_Chain, SANDBOXPROJECT_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Simulated Chains"), STAT_ChainSimulatedChains, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances Uploaded"), STAT_ChainInstancesUploaded, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sleeping Chains"), STAT_ChainSleepingChains, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chain Substeps"), STAT_ChainSubsteps, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Solver Iterations"), STAT_ChainSolverIterations, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chain Collision Pairs"), STAT_ChainCollisionPairs, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Replicated Keyframes"), STAT_ChainReplicatedKeyframes, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dispatched Events"), STAT_ChainDispatchedEvents, STATGROUP_Chain, SANDBOXPROJECT_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Max Solver Residual"), STAT_ChainSolverResidual, STATGROUP_Chain, SANDBOXPROJECT_API);
+
+/**
+ * Phases of a chain step, as reported by FChainPhaseTimings.
+ */
+enum class EChainPhase : uint8
+{
+	/** Attachment pins, sleep and level of detail in PreSimulate. */
+	Pins,
+
+	/** Gravity and external forces, part of Constraints for the vectorized backend. */
+	Gravity,
+
+	/** Distance and follow constraints. */
+	Constraints,
+
+	/** Self collision and world sweeps. */
+	Collision,
+
+	/** Collide and sound events. */
+	Events,
+
+	/** Instance upload or render point packing. */
+	Meshes,
+
+	/** Components attached to the chain ends. */
+	Attachments,
+
+	Num
+};
+
+/**
+ * Cycles spent in each phase of the steps of one chain, filled while the chain has it as its timing sink.
+ * Accumulates without synchronization, a sink must not be shared by chains simulated in parallel.
+ */
+struct SANDBOXPROJECT_API FChainPhaseTimings
+{
+	/** Cycles per phase. */
+	uint64 Cycles[static_cast<int32>(EChainPhase::Num)] = {};
+
+	/**
+	 * Adds the cycles of another sink.
+	 */
+	void Accumulate(const FChainPhaseTimings& Other);
+
+	/**
+	 * @return The time spent in the phase in milliseconds.
+	 */
+	double GetMilliseconds(EChainPhase Phase) const;
+
+	/**
+	 * @return The name of the phase, used as column name of benchmark reports.
+	 */
+	static const TCHAR* GetPhaseName(EChainPhase Phase);
+};
+
+/**
+ * Adds the cycles of its scope to a phase of a timing sink, does nothing without a sink.
+ */
+struct FChainPhaseScope
+{
+	FORCEINLINE FChainPhaseScope(FChainPhaseTimings* InTimings, EChainPhase InPhase)
+		: Timings(InTimings), Phase(InPhase), StartCycles(InTimings ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	FORCEINLINE ~FChainPhaseScope()
+	{
+		if (Timings)
+		{
+			Timings->Cycles[static_cast<int32>(Phase)] += FPlatformTime::Cycles64() - StartCycles;
+		}
+	}
+
+private:
+	FChainPhaseTimings* Timings;
+	EChainPhase Phase;
+	uint64 StartCycles;
+};
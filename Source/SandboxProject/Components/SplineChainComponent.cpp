@@ -3,6 +3,12 @@
 #include "SplineChainComponent.h"
 #include "Components/SplineComponent.h"
 
+namespace SplineChainFollow
+{
+	/** Follow weight below which a point is pinned to the spline. */
+	constexpr float PinThreshold = 0.5f;
+}
+
 /**
  * Constructor for USplineChainComponent.
  * Initializes the spline follow weight curve and sets default attachment values.
@@ -95,50 +101,132 @@ void USplineChainComponent::OnRegister()
 }
 
 /**
- * Called every frame to update the component's behavior.
- * This function checks if the spline follow weight has changed and updates the chain points accordingly.
+ * Called before every simulation step, either from the component tick or from the simulation subsystem.
+ * This function copies the baked free flags of the spline follow weight into the chain points and moves the follow targets with the spline.
  *
  * @param DeltaTime Time elapsed since last frame.
- * @param TickType Type of tick for this component.
- * @param ThisTickFunction Contains tick information for this component.
+ * @return True if the chain steps this frame.
  */
-void USplineChainComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+bool USplineChainComponent::PreSimulate(float DeltaTime)
 {
-	if (SplineComponent)
+	if (SplineComponent && BakedFreeFlags.Num() == GetNumChainPoints())
 	{
-#if WITH_EDITOR
+		FMemory::Memcpy(FreeFlags.GetData(), BakedFreeFlags.GetData(), BakedFreeFlags.Num() * sizeof(bool));
+		UpdateSplineTargets();
+	}
 
-		float Check = 0;
+	return Super::PreSimulate(DeltaTime);
+}
 
-		for (auto& Key : SplineFollowWeight.GetRichCurveConst()->GetConstRefOfKeys())
-		{
-			Check += Key.Value;
-		}
+/**
+ * Transforms the baked spline locations into world space follow targets.
+ * Pinned points are placed on their target, moving them wakes a sleeping chain.
+ * The first and the last point are left to the attachments of the base component.
+ */
+void USplineChainComponent::UpdateSplineTargets()
+{
+	const FTransform& SplineTransform = SplineComponent->GetComponentTransform();
+	bool bPinsMoved = false;
+
+	for (int32 i = 0; i < BakedSplineLocations.Num(); i++)
+	{
+		FollowTargets[i] = SplineTransform.TransformPosition(BakedSplineLocations[i]);
 
-		if (Check != SplineFollowWeightCheck)
+		if (! BakedFreeFlags[i] && i > 0 && i < BakedSplineLocations.Num() - 1)
 		{
-			SplineFollowWeightCheck = Check;
-			InitChain();
+			// Sleeping chains keep the pose they fell asleep in as old positions, slow spline motion adds up against it.
+			bPinsMoved |= ! OldPositions[i].Equals(FollowTargets[i], SleepAttachmentTolerance);
+			Positions[i] = FollowTargets[i];
 		}
-#endif
-		for (auto& Point : ChainPoints)
-		{
-			bool FollowWiightMore = SplineFollowWeight.GetRichCurveConst()->Eval(Point.Time) < 0.5f;
+	}
+
+	if (bPinsMoved && IsChainSleeping())
+	{
+		WakeChain();
+	}
+}
 
-			FollowWiightMore ? (Point.bFree = false) : (Point.bFree = true);
+/**
+ * Samples the follow weight curve and the spline for every chain point into the lookup tables.
+ * The spline locations are stored relative to the spline component, so the tables stay valid when the actor moves.
+ * Also fills the follow targets and stiffness of the base component.
+ */
+void USplineChainComponent::RebakeSpline()
+{
+	const int32 NumPoints = GetNumChainPoints();
 
-			if (SplineFollowWeight.GetRichCurveConst()->Eval(Point.Time) < 0.5f)
-			{
-				Point.bFree = false;
-			}
-			else
-			{
-				Point.bFree = true;
-			}
-		}
+	BakedFollowWeights.SetNumUninitialized(NumPoints);
+	BakedFreeFlags.SetNumUninitialized(NumPoints);
+	BakedSplineLocations.SetNumUninitialized(NumPoints);
+
+	if (! SplineComponent)
+	{
+		FollowTargets.Reset();
+		FollowStiffness.Reset();
+		return;
+	}
+
+	FollowTargets.SetNumUninitialized(NumPoints);
+	FollowStiffness.SetNumUninitialized(NumPoints);
+
+	const FRichCurve* FollowWeightCurve = SplineFollowWeight.GetRichCurveConst();
+
+	// Sampled by time, so a spline changed at runtime is covered with the same number of points.
+	const float ChainDistance = SplineComponent->GetSplineLength() * ChainLength;
+
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		BakedFollowWeights[i] = FollowWeightCurve->Eval(PointTimes[i]);
+		BakedFreeFlags[i] = BakedFollowWeights[i] >= SplineChainFollow::PinThreshold;
+		BakedSplineLocations[i] = SplineComponent->GetLocationAtDistanceAlongSpline(PointTimes[i] * ChainDistance, ESplineCoordinateSpace::Local);
+
+		// Strongest right above the pin threshold and gone at a weight of 1, so the pull does not jump next to the pinned points.
+		const float PinAlpha = FMath::Clamp((1.0f - BakedFollowWeights[i]) / (1.0f - SplineChainFollow::PinThreshold), 0.0f, 1.0f);
+		FollowStiffness[i] = PinAlpha * SplineFollowStiffness;
+	}
+
+	UpdateSplineTargets();
+}
+
+/**
+ * Adds the shape of the spline to the settings the baked rest pose depends on.
+ *
+ * @return The hash of the base component combined with the spline length and end location.
+ */
+uint32 USplineChainComponent::GetRestPoseHash() const
+{
+	uint32 Hash = Super::GetRestPoseHash();
+
+	if (SplineComponent)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(SplineComponent->GetSplineLength()));
+		Hash = HashCombine(Hash, GetTypeHash(SplineComponent->GetLocationAtTime(1, ESplineCoordinateSpace::Local)));
+	}
+
+	return Hash;
+}
+
+#if WITH_EDITOR
+/**
+ * Called after a property was changed in the editor.
+ * Spline edits re-register the component and re-initialize the chain through OnRegister, curve edits end up here.
+ */
+void USplineChainComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(USplineChainComponent, SplineFollowStiffness))
+	{
+		RebakeSpline();
+	}
+	else if (PropertyName == GET_MEMBER_NAME_CHECKED(USplineChainComponent, SplineFollowWeight) || PropertyName == GET_MEMBER_NAME_CHECKED(UChainComponent, Segments) || PropertyName == GET_MEMBER_NAME_CHECKED(UChainComponent, ChainLength))
+	{
+		InitChain();
 	}
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 }
+#endif
 
 /**
  * Initializes the chain by setting the start and end points and creating the chain instances.
@@ -149,8 +237,7 @@ void USplineChainComponent::InitChain()
 	if (SplineComponent)
 	{
 		InstanceComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		ChainPoints.Empty();
-		ChainPoints.AddUninitialized(Segments);
+		ResizeChainBuffers(Segments);
 		ChainStart = GetComponentLocation();
 		if (bIsLocal)
 		{
@@ -162,24 +249,28 @@ void USplineChainComponent::InitChain()
 		}
 		// const FVector LengthVector = ChainEnd - ChainStart;
 		InstanceComponent->SetStaticMesh(ChainMesh);
-		InstanceComponent->ClearInstances();
 
-		if (InstanceComponent->GetInstanceCount() == 0)
+		float SegmentTime = 1.0f / static_cast<float>(Segments);
+		SegmentLength = (SplineComponent->GetSplineLength() / static_cast<float>(Segments)) * ChainLength;
+
+		for (int i = 0; i < Segments; i++)
 		{
-			float SegmentTime = 1.0f / static_cast<float>(Segments);
-			SegmentLength = (SplineComponent->GetSplineLength() / static_cast<float>(Segments)) * ChainLength;
+			PointTimes[i] = static_cast<float>(i) * SegmentTime;
+		}
 
-			for (int i = 0; i < Segments; i++)
-			{
-				FChainPointData Point = FChainPointData();
-				Point.Time = static_cast<float>(i) * SegmentTime;
-				Point.Position = SplineComponent->GetLocationAtDistanceAlongSpline(i * SegmentLength, ESplineCoordinateSpace::World);
-				Point.OldPosition = Point.Position;
-				Point.Transform.SetScale3D(Scale);
-				ChainPoints[i] = Point;
-				InstanceComponent->AddInstance(Point.Transform);
-			}
+		RebakeSpline();
+
+		const FTransform& SplineTransform = SplineComponent->GetComponentTransform();
+
+		for (int i = 0; i < Segments; i++)
+		{
+			Positions[i] = SplineTransform.TransformPosition(BakedSplineLocations[i]);
+			OldPositions[i] = Positions[i];
 		}
+
+		SyncChainInstances(Segments);
+		ResetSimulationState();
+		ApplyRestPose();
 	}
 	else
 	{
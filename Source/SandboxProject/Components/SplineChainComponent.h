@@ -33,28 +33,60 @@ public:
 	virtual void OnRegister() override;
 	
 	/**
-	 * Called every frame. Handles updating the component's behavior.
+	 * Initializes the chain, setting up the spline-based logic for the component.
+	 */
+	virtual void InitChain() override;
+
+#if WITH_EDITOR
+	/**
+	 * Re-initializes the chain when a property the spline tables depend on changed.
+	 */
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/**
+	 * Samples the follow weight curve and the spline again for every chain point.
+	 * Call after changing the spline or SplineFollowWeight at runtime, the chain then moves to the new spline without being re-initialized.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Spline Chain Component")
+	void RebakeSpline();
+
+protected:
+	/**
+	 * Called before every simulation step. Updates the free points and the follow targets from the spline.
 	 *
 	 * @param DeltaTime Time elapsed since last frame.
-	 * @param TickType Type of tick for this component.
-	 * @param ThisTickFunction Contains tick information for this component.
+	 * @return True if the chain steps this frame.
 	 */
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual bool PreSimulate(float DeltaTime) override;
 
 	/**
-	 * Initializes the chain, setting up the spline-based logic for the component.
+	 * @return The hash of the base component combined with the shape of the spline.
 	 */
-	virtual void InitChain() override;
-
+	virtual uint32 GetRestPoseHash() const override;
 
+public:
 	/**
 	 * Curve that defines the weight for following the spline. Can be edited in the editor or set at runtime.
 	 */	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spline Chain Component")
 	FRuntimeFloatCurve SplineFollowWeight;
 
+	/**
+	 * Fraction of the distance to the spline a free point closes in one simulation step right above the pin threshold.
+	 * Points below a follow weight of 0.5 are pinned to the spline. Above it the pull fades out linearly and reaches 0 at a weight of 1,
+	 * so a value of 1 blends continuously into the pinned points. 0 leaves every free point free.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spline Chain Component", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float SplineFollowStiffness = 0.0f;
+
 
 private:
+	/**
+	 * Moves the follow targets and the pinned points to the current transform of the spline component.
+	 */
+	void UpdateSplineTargets();
+
 	/**
 	 * The spline component that defines the path for the chain.
 	 */
@@ -62,9 +94,19 @@ private:
 	USplineComponent* SplineComponent;
 
 	/**
-	 * A float variable used to track or check the spline follow weight internally.
+	 * SplineFollowWeight sampled at the time of each chain point.
+	 */
+	TArray<float> BakedFollowWeights;
+
+	/**
+	 * Whether each chain point is free, derived from BakedFollowWeights.
+	 */
+	TArray<bool> BakedFreeFlags;
+
+	/**
+	 * Location of each chain point along the spline, in the space of the spline component.
 	 */
-	float SplineFollowWeightCheck;
+	TArray<FVector> BakedSplineLocations;
 
 
 };
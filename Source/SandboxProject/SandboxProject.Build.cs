@@ -21,7 +21,12 @@ public class SandboxProject : ModuleRules
 			"DelegateModule",
 			"ThreadsModule",
 			"DataRegistry",
-			"TagsModule"
+			"TagsModule",
+			"SignificanceManager",
+			"RenderCore",
+			"RHI",
+			"Json",
+			"NetCore"
 		});
 	}
 }
@@ -0,0 +1,156 @@
+// This is Sandbox Project.
+
+#include "ChainPoolSubsystem.h"
+#include "SandboxProject/Components/ChainComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+DEFINE_LOG_CATEGORY_STATIC(ChainPoolLog, All, All);
+
+bool UChainPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UChainPoolSubsystem::Deinitialize()
+{
+	PooledChains.Reset();
+	PoolActor = nullptr;
+
+	Super::Deinitialize();
+}
+
+int32 UChainPoolSubsystem::PrewarmChains(TSubclassOf<UChainComponent> ChainClass, int32 Count, int32 Segments)
+{
+	UClass* Class = ChainClass ? ChainClass.Get() : UChainComponent::StaticClass();
+	int32 NumCreated = 0;
+
+	PooledChains.Reserve(PooledChains.Num() + Count);
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		if (UChainComponent* Chain = CreatePooledChain(Class, Segments))
+		{
+			PooledChains.Add(Chain);
+			NumCreated++;
+		}
+	}
+
+	return NumCreated;
+}
+
+UChainComponent* UChainPoolSubsystem::AcquireChain(TSubclassOf<UChainComponent> ChainClass, int32 Segments, FTransform Transform, USceneComponent* AttachParent)
+{
+	UClass* Class = ChainClass ? ChainClass.Get() : UChainComponent::StaticClass();
+	int32 FoundIndex = INDEX_NONE;
+
+	for (int32 i = PooledChains.Num() - 1; i >= 0; i--)
+	{
+		const UChainComponent* Pooled = PooledChains[i];
+
+		if (! IsValid(Pooled))
+		{
+			PooledChains.RemoveAtSwap(i, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		if (Pooled->GetClass() != Class) continue;
+
+		FoundIndex = i;
+		if (Pooled->Segments == Segments) break;
+	}
+
+	UChainComponent* Chain = nullptr;
+
+	if (FoundIndex != INDEX_NONE)
+	{
+		Chain = PooledChains[FoundIndex];
+		PooledChains.RemoveAtSwap(FoundIndex, 1, EAllowShrinking::No);
+	}
+	else
+	{
+		UE_LOG(ChainPoolLog, Verbose, TEXT("No pooled %s, creating one. Prewarm the pool to avoid creating chains during gameplay."), *Class->GetName());
+
+		Chain = CreatePooledChain(Class, Segments);
+		if (! Chain) return nullptr;
+	}
+
+	if (AttachParent)
+	{
+		Chain->AttachToComponent(AttachParent, FAttachmentTransformRules::KeepRelativeTransform);
+		Chain->SetRelativeTransform(Transform);
+	}
+	else
+	{
+		Chain->SetWorldTransform(Transform);
+	}
+
+	// Buffers and instances of the same size are reset in place.
+	Chain->Segments = Segments;
+	Chain->InvalidateAttachments();
+	Chain->InitChain();
+	Chain->SetChainPooled(false);
+
+	return Chain;
+}
+
+void UChainPoolSubsystem::ReleaseChain(UChainComponent* Chain)
+{
+	if (! IsValid(Chain) || Chain->IsChainPooled() || ! PoolActor || Chain->GetOwner() != PoolActor) return;
+
+	Chain->SetChainPooled(true);
+
+	// Parked chains keep no gameplay object alive and call no handler of their previous user.
+	Chain->OnCollide.Clear();
+	Chain->OnSoundReached.Clear();
+	Chain->OnChainBroken.Clear();
+
+	Chain->AttachStartTo = FComponentReference();
+	Chain->AttachEndTo = FComponentReference();
+	Chain->AttachComponentToStart = FComponentReference();
+	Chain->AttachComponentToEnd = FComponentReference();
+	Chain->AttachStartToSocket = NAME_None;
+	Chain->AttachEndToSocket = NAME_None;
+	Chain->InvalidateAttachments();
+
+	Chain->AttachToComponent(PoolActor->GetRootComponent(), FAttachmentTransformRules::KeepWorldTransform);
+
+	PooledChains.Add(Chain);
+}
+
+UChainComponent* UChainPoolSubsystem::CreatePooledChain(UClass* ChainClass, int32 Segments)
+{
+	AActor* Owner = GetPoolActor();
+	if (! Owner) return nullptr;
+
+	UChainComponent* Chain = NewObject<UChainComponent>(Owner, ChainClass, NAME_None, RF_Transient);
+	Chain->Segments = Segments;
+
+	// Parked before the registration, so the chain never enters the simulation while pooled.
+	Chain->SetChainPooled(true);
+	Chain->SetupAttachment(Owner->GetRootComponent());
+	Chain->RegisterComponent();
+
+	return Chain;
+}
+
+AActor* UChainPoolSubsystem::GetPoolActor()
+{
+	if (IsValid(PoolActor)) return PoolActor;
+
+	UWorld* World = GetWorld();
+	if (! World) return nullptr;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Name = MakeUniqueObjectName(World->PersistentLevel, AActor::StaticClass(), TEXT("ChainPool"));
+	SpawnParameters.ObjectFlags |= RF_Transient;
+
+	PoolActor = World->SpawnActor<AActor>(SpawnParameters);
+	if (! PoolActor) return nullptr;
+
+	USceneComponent* Root = NewObject<USceneComponent>(PoolActor, TEXT("Root"));
+	PoolActor->SetRootComponent(Root);
+	Root->RegisterComponent();
+
+	return PoolActor;
+}
@@ -0,0 +1,88 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ChainPoolSubsystem.generated.h"
+
+class UChainComponent;
+
+/**
+ * World subsystem that keeps registered chain components around for dynamically spawned cables,
+ * e.g. grappling hooks and temporary ropes.
+ *
+ * Pooled chains are owned by one transient pool actor. They keep their point buffers and instances
+ * between uses and are only hidden and taken out of the simulation while parked. Acquiring a chain
+ * moves it and reinitializes it in place, so there is no UObject creation, registration or garbage
+ * during gameplay once the pool is warm.
+ *
+ * Only game and PIE worlds are supported.
+ */
+UCLASS()
+class SANDBOXPROJECT_API UChainPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Creates and parks chains ahead of time, e.g. during level load.
+	 *
+	 * @param ChainClass The class of the chains, UChainComponent if null.
+	 * @param Count The number of chains to add to the pool.
+	 * @param Segments The number of points of the chains.
+	 * @return The number of chains created.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	int32 PrewarmChains(TSubclassOf<UChainComponent> ChainClass, int32 Count, int32 Segments = 10);
+
+	/**
+	 * Takes a chain out of the pool, or creates one if the pool has none of the class.
+	 * A parked chain with the same segment count is preferred, its buffers and instances are reused as they are.
+	 * The chain keeps the settings of its previous use, only attachments and event bindings are cleared on release.
+	 *
+	 * @param ChainClass The class of the chain, UChainComponent if null.
+	 * @param Segments The number of points of the chain.
+	 * @param Transform The transform of the chain, relative to AttachParent if given, in world space otherwise.
+	 * @param AttachParent The component the chain is attached to, may be null.
+	 * @return The chain, initialized and simulated from the next frame.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	UChainComponent* AcquireChain(TSubclassOf<UChainComponent> ChainClass, int32 Segments, FTransform Transform, USceneComponent* AttachParent = nullptr);
+
+	/**
+	 * Parks a chain acquired from this pool. Chains from anywhere else are ignored.
+	 *
+	 * @param Chain The chain to return.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	void ReleaseChain(UChainComponent* Chain);
+
+	/**
+	 * @return The number of chains currently parked.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Chain")
+	FORCEINLINE int32 GetNumPooledChains() const { return PooledChains.Num(); }
+
+private:
+	/**
+	 * Creates a registered and parked chain owned by the pool actor.
+	 */
+	UChainComponent* CreatePooledChain(UClass* ChainClass, int32 Segments);
+
+	/**
+	 * @return The actor owning the pooled chains, spawned on first use.
+	 */
+	AActor* GetPoolActor();
+
+	/** Owner of every chain of the pool. */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> PoolActor;
+
+	/** Parked chains. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UChainComponent>> PooledChains;
+};
@@ -0,0 +1,555 @@
+// This is Sandbox Project.
+
+#include "ChainSimulationSubsystem.h"
+#include "SandboxProject/Components/ChainComponent.h"
+#include "SandboxProject/Components/ChainStats.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "GameFramework/PlayerController.h"
+#include "SignificanceManager.h"
+#include <atomic>
+
+static TAutoConsoleVariable<int32> CVarChainParallelSimulation(TEXT("Chain.ParallelSimulation"), 1, TEXT("Run the chain solver of all chains on worker threads.\n0: game thread only, 1: ParallelFor (default)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarChainMaxEventsPerFrame(TEXT("Chain.MaxEventsPerFrame"), 0, TEXT("Maximal number of chain collide and sound events broadcast per frame across the world.\nChains over the budget keep their events for a later frame.\n0: unlimited (default)"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarChainMaxChainCollisionTests(TEXT("Chain.MaxChainCollisionTests"), 50000, TEXT("Maximal number of chain to chain collision candidates visited per frame across the world, split evenly between the colliding chains.\nChains over their share continue with their remaining points on the next frame.\n0: unlimited"), ECVF_Default);
+static TAutoConsoleVariable<int32> CVarChainUpdateSignificance(TEXT("Chain.UpdateSignificance"), 1, TEXT("Update the significance manager with the local player viewpoints before stepping the chains.\nDisable if the game already updates the significance manager every frame.\n0: off, 1: on (default)"), ECVF_Default);
+
+namespace ChainForceFieldGrid
+{
+	/** Edge length of a grid cell in cm. */
+	constexpr double CellSize = 2500.0;
+
+	/** Fields and boxes covering more cells skip the grid and are tested directly. */
+	constexpr int64 MaxCells = 64;
+
+	/** Distance in cm the chain bounds are expanded by in the query grid, covers chains moving after the grid was built. */
+	constexpr double QueryMargin = 100.0;
+
+	FIntVector GetCell(const FVector& Location)
+	{
+		return FIntVector(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize), FMath::FloorToInt32(Location.Z / CellSize));
+	}
+
+	int64 GetNumCells(const FIntVector& Min, const FIntVector& Max)
+	{
+		return static_cast<int64>(Max.X - Min.X + 1) * (Max.Y - Min.Y + 1) * (Max.Z - Min.Z + 1);
+	}
+}
+
+bool UChainSimulationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UChainSimulationSubsystem::Deinitialize()
+{
+	Chains.Reset();
+	SteppingChains.Reset();
+	CollidingChains.Reset();
+	CollidingChainIndices.Reset();
+	ChainCollisionWorld.Reset();
+	SignificanceViewpoints.Reset();
+	EventChains.Reset();
+	EventChainIndices.Reset();
+	ForceFields.Reset();
+	Impulses.Reset();
+	ImpulseExpireFrames.Reset();
+	ForceFieldCells.Reset();
+	GlobalForceFields.Reset();
+	QueryChains.Reset();
+	QueryChainCells.Reset();
+	GlobalQueryChains.Reset();
+	QueryGridFrame = MAX_uint64;
+
+	Super::Deinitialize();
+}
+
+void UChainSimulationSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ChainSubsystemTick);
+
+	SteppingChains.Reset();
+
+	if (CVarChainUpdateSignificance.GetValueOnGameThread() != 0)
+	{
+		UpdateSignificance();
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ChainPreSimulate);
+
+		for (UChainComponent* Chain : Chains)
+		{
+			if (IsValid(Chain) && Chain->PreSimulate(DeltaTime))
+			{
+				SteppingChains.Add(Chain);
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_ChainSimulatedChains, SteppingChains.Num());
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ChainSimulate);
+
+		const EParallelForFlags Flags = CVarChainParallelSimulation.GetValueOnGameThread() != 0 ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+		ParallelFor(SteppingChains.Num(), [this](int32 Index) { SteppingChains[Index]->Simulate(); }, Flags);
+	}
+
+	ResolveChainCollision();
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ChainPostSimulate);
+
+		float MaxResidual = 0.0f;
+
+		for (UChainComponent* Chain : SteppingChains)
+		{
+			if (IsValid(Chain))
+			{
+				MaxResidual = FMath::Max(MaxResidual, Chain->GetLastSolverResidual());
+				Chain->PostSimulate();
+			}
+		}
+
+		SET_FLOAT_STAT(STAT_ChainSolverResidual, MaxResidual);
+
+		DispatchChainEvents();
+
+		for (UChainComponent* Chain : Chains)
+		{
+			if (IsValid(Chain))
+			{
+				Chain->UpdateRender();
+				Chain->DrawChainPoints();
+			}
+		}
+	}
+
+	ExpireImpulses();
+}
+
+void UChainSimulationSubsystem::UpdateSignificance()
+{
+	UWorld* World = GetWorld();
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(World);
+	if (! SignificanceManager || Chains.Num() == 0) return;
+
+	SignificanceViewpoints.Reset();
+
+	for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			SignificanceViewpoints.Emplace(Rotation, Location);
+		}
+	}
+
+	if (SignificanceViewpoints.Num() > 0)
+	{
+		SignificanceManager->Update(SignificanceViewpoints);
+	}
+}
+
+void UChainSimulationSubsystem::DispatchChainEvents()
+{
+	const int32 NumChains = Chains.Num();
+	if (NumChains == 0) return;
+
+	// Round robin over all chains, so a tight budget does not starve the chains at the end.
+	// The chains are collected first, handlers may register or unregister chains while broadcasting.
+	const int32 FirstIndex = EventCursor % NumChains;
+
+	EventChains.Reset();
+	EventChainIndices.Reset();
+
+	for (int32 Offset = 0; Offset < NumChains; Offset++)
+	{
+		const int32 Index = (FirstIndex + Offset) % NumChains;
+		UChainComponent* Chain = Chains[Index];
+
+		if (IsValid(Chain) && Chain->HasPendingEvents())
+		{
+			EventChains.Add(Chain);
+			EventChainIndices.Add(Index);
+		}
+	}
+
+	const int32 Budget = CVarChainMaxEventsPerFrame.GetValueOnGameThread();
+	int32 NumEvents = 0;
+
+	for (int32 k = 0; k < EventChains.Num(); k++)
+	{
+		UChainComponent* Chain = EventChains[k];
+
+		// Handlers may destroy other chains, so validity is checked for every chain.
+		if (! IsValid(Chain) || ! Chain->HasPendingEvents()) continue;
+
+		if (Budget > 0 && NumEvents >= Budget)
+		{
+			EventCursor = EventChainIndices[k];
+			break;
+		}
+
+		NumEvents += Chain->DispatchEvents();
+	}
+
+	INC_DWORD_STAT_BY(STAT_ChainDispatchedEvents, NumEvents);
+}
+
+void UChainSimulationSubsystem::ResolveChainCollision()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ChainToChainCollision);
+
+	ChainCollisionWorld.Reset();
+	CollidingChains.Reset();
+	CollidingChainIndices.Reset();
+
+	for (UChainComponent* Chain : Chains)
+	{
+		if (! IsValid(Chain) || ! Chain->bChainCollision || Chain->ChainCollisionRadius <= 0.0f || Chain->Positions.Num() < 2) continue;
+
+		// Chains that did not step this frame, e.g. sleeping ones, are static obstacles for the others.
+		const bool bStepping = Chain->NumSubsteps > 0;
+		const int32 ChainIndex = ChainCollisionWorld.AddChain(Chain->Positions, Chain->ChainCollisionRadius, Chain->ChainCollisionGroups, Chain->ChainCollisionMask, bStepping);
+
+		if (bStepping)
+		{
+			CollidingChains.Add(Chain);
+			CollidingChainIndices.Add(ChainIndex);
+		}
+	}
+
+	if (CollidingChains.Num() == 0 || ChainCollisionWorld.GetNumChains() < 2) return;
+
+	ChainCollisionWorld.Build();
+
+	const int32 MaxTests = CVarChainMaxChainCollisionTests.GetValueOnGameThread();
+	const int32 Budget = MaxTests > 0 ? FMath::Max(MaxTests / CollidingChains.Num(), 1) : MAX_int32;
+
+	std::atomic<int32> NumTests = 0;
+
+	const EParallelForFlags Flags = CVarChainParallelSimulation.GetValueOnGameThread() != 0 ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	ParallelFor(CollidingChains.Num(), [this, Budget, &NumTests](int32 Index)
+	{
+		NumTests += CollidingChains[Index]->ResolveChainCollision(ChainCollisionWorld, CollidingChainIndices[Index], Budget);
+	}, Flags);
+
+	INC_DWORD_STAT_BY(STAT_ChainCollisionPairs, NumTests.load());
+}
+
+int32 UChainSimulationSubsystem::ApplyRadialForceToChains(FVector Origin, float Radius, FVector Force)
+{
+	UpdateQueryGrid();
+
+	GatheredQueryChains.Reset();
+	GatheredQueryChains.Append(GlobalQueryChains);
+
+	const FIntVector MinCell = ChainForceFieldGrid::GetCell(Origin - FVector(Radius));
+	const FIntVector MaxCell = ChainForceFieldGrid::GetCell(Origin + FVector(Radius));
+
+	if (ChainForceFieldGrid::GetNumCells(MinCell, MaxCell) > ChainForceFieldGrid::MaxCells)
+	{
+		// Huge spheres are cheaper to test against every chain than to walk the grid.
+		GatheredQueryChains.Reset();
+
+		for (int32 i = 0; i < QueryChains.Num(); i++)
+		{
+			GatheredQueryChains.Add(i);
+		}
+	}
+	else
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+				{
+					if (const TArray<int32>* CellChains = QueryChainCells.Find(FIntVector(X, Y, Z)))
+					{
+						for (const int32 ChainIndex : *CellChains)
+						{
+							GatheredQueryChains.AddUnique(ChainIndex);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	int32 NumAffectedChains = 0;
+
+	for (const int32 ChainIndex : GatheredQueryChains)
+	{
+		UChainComponent* Chain = QueryChains[ChainIndex];
+
+		if (IsValid(Chain) && Chain->OverlapsSphere(Origin, Radius) && Chain->ApplyForce(Origin, Radius, Force, AffectedPoints) > 0)
+		{
+			NumAffectedChains++;
+		}
+	}
+
+	return NumAffectedChains;
+}
+
+void UChainSimulationSubsystem::UpdateQueryGrid()
+{
+	if (QueryGridFrame == GFrameCounter) return;
+	QueryGridFrame = GFrameCounter;
+
+	QueryChainCells.Reset();
+	GlobalQueryChains.Reset();
+
+	for (int32 i = 0; i < QueryChains.Num(); i++)
+	{
+		const UChainComponent* Chain = QueryChains[i];
+		if (! IsValid(Chain) || Chain->GetNumChainPoints() == 0) continue;
+
+		const FBox Bounds = Chain->GetChainBounds().ExpandBy(ChainForceFieldGrid::QueryMargin);
+		const FIntVector MinCell = ChainForceFieldGrid::GetCell(Bounds.Min);
+		const FIntVector MaxCell = ChainForceFieldGrid::GetCell(Bounds.Max);
+
+		if (ChainForceFieldGrid::GetNumCells(MinCell, MaxCell) > ChainForceFieldGrid::MaxCells)
+		{
+			GlobalQueryChains.Add(i);
+			continue;
+		}
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+				{
+					QueryChainCells.FindOrAdd(FIntVector(X, Y, Z)).Add(i);
+				}
+			}
+		}
+	}
+}
+
+int32 UChainSimulationSubsystem::AddForceField(const FChainForceField& Field)
+{
+	const int32 Handle = NextForceFieldHandle++;
+
+	FChainForceField& Added = ForceFields.Add(Handle, Field);
+	Added.Direction = Added.Direction.GetSafeNormal();
+	Added.bImpulse = false;
+	bForceFieldGridDirty = true;
+
+	return Handle;
+}
+
+bool UChainSimulationSubsystem::UpdateForceField(int32 Handle, const FChainForceField& Field)
+{
+	FChainForceField* Updated = ForceFields.Find(Handle);
+	if (! Updated) return false;
+
+	// Moving or resizing a field changes its cells, anything else keeps the grid valid.
+	if (Updated->Location != Field.Location || Updated->Radius != Field.Radius)
+	{
+		bForceFieldGridDirty = true;
+	}
+
+	*Updated = Field;
+	Updated->Direction = Updated->Direction.GetSafeNormal();
+	Updated->bImpulse = false;
+
+	return true;
+}
+
+bool UChainSimulationSubsystem::RemoveForceField(int32 Handle)
+{
+	if (ForceFields.Remove(Handle) == 0) return false;
+
+	bForceFieldGridDirty = true;
+	return true;
+}
+
+void UChainSimulationSubsystem::AddRadialImpulseToChains(FVector Origin, float Radius, float Strength, bool bFalloff)
+{
+	FChainForceField& Impulse = Impulses.AddDefaulted_GetRef();
+	Impulse.Type = EChainForceFieldType::Radial;
+	Impulse.Location = Origin;
+	Impulse.Radius = Radius;
+	Impulse.Strength = Strength;
+	Impulse.bFalloff = bFalloff;
+	Impulse.bImpulse = true;
+	Impulse.ImpulseSerial = ++LastImpulseSerial;
+
+	// Chains gather impulses once per step interval, the impulse stays pending until the slowest one stepped.
+	// The extra frame covers chains ticking on their own after the subsystem.
+	int32 MaxInterval = 1;
+
+	for (const UChainComponent* Chain : QueryChains)
+	{
+		if (IsValid(Chain))
+		{
+			MaxInterval = FMath::Max(MaxInterval, Chain->GetStepInterval());
+		}
+	}
+
+	ImpulseExpireFrames.Add(GFrameCounter + MaxInterval + 1);
+}
+
+void UChainSimulationSubsystem::GatherForceFields(const FBox& Bounds, TArray<FChainForceField>& OutFields, TArray<FChainForceField>& OutImpulses, uint32& AppliedImpulseSerial) const
+{
+	OutFields.Reset();
+
+	if (ForceFields.Num() > 0)
+	{
+		if (bForceFieldGridDirty)
+		{
+			RebuildForceFieldGrid();
+		}
+
+		GatheredForceFields.Reset();
+		GatheredForceFields.Append(GlobalForceFields);
+
+		const FIntVector MinCell = ChainForceFieldGrid::GetCell(Bounds.Min);
+		const FIntVector MaxCell = ChainForceFieldGrid::GetCell(Bounds.Max);
+
+		if (ChainForceFieldGrid::GetNumCells(MinCell, MaxCell) > ChainForceFieldGrid::MaxCells)
+		{
+			// Huge boxes are cheaper to test against every bounded field than to walk the grid.
+			GatheredForceFields.Reset();
+			ForceFields.GetKeys(GatheredForceFields);
+		}
+		else
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+			{
+				for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+				{
+					for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+					{
+						if (const TArray<int32>* CellFields = ForceFieldCells.Find(FIntVector(X, Y, Z)))
+						{
+							for (const int32 Handle : *CellFields)
+							{
+								GatheredForceFields.AddUnique(Handle);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		for (const int32 Handle : GatheredForceFields)
+		{
+			const FChainForceField& Field = ForceFields.FindChecked(Handle);
+
+			if (Field.Strength != 0.0f && Field.Overlaps(Bounds))
+			{
+				OutFields.Add(Field);
+			}
+		}
+	}
+
+	for (const FChainForceField& Impulse : Impulses)
+	{
+		if (Impulse.ImpulseSerial > AppliedImpulseSerial && Impulse.Overlaps(Bounds))
+		{
+			OutImpulses.Add(Impulse);
+		}
+	}
+
+	AppliedImpulseSerial = LastImpulseSerial;
+}
+
+void UChainSimulationSubsystem::RebuildForceFieldGrid() const
+{
+	ForceFieldCells.Reset();
+	GlobalForceFields.Reset();
+	bForceFieldGridDirty = false;
+
+	for (const TPair<int32, FChainForceField>& Pair : ForceFields)
+	{
+		const FChainForceField& Field = Pair.Value;
+
+		if (Field.IsUnbounded())
+		{
+			GlobalForceFields.Add(Pair.Key);
+			continue;
+		}
+
+		const FVector Extent(Field.Radius);
+		const FIntVector MinCell = ChainForceFieldGrid::GetCell(Field.Location - Extent);
+		const FIntVector MaxCell = ChainForceFieldGrid::GetCell(Field.Location + Extent);
+
+		if (ChainForceFieldGrid::GetNumCells(MinCell, MaxCell) > ChainForceFieldGrid::MaxCells)
+		{
+			GlobalForceFields.Add(Pair.Key);
+			continue;
+		}
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+				{
+					ForceFieldCells.FindOrAdd(FIntVector(X, Y, Z)).Add(Pair.Key);
+				}
+			}
+		}
+	}
+}
+
+void UChainSimulationSubsystem::ExpireImpulses()
+{
+	// Impulses added later may expire earlier, the chains stepping slowest can change in between.
+	int32 NumKept = 0;
+
+	for (int32 i = 0; i < Impulses.Num(); i++)
+	{
+		if (ImpulseExpireFrames[i] > GFrameCounter)
+		{
+			Impulses[NumKept] = Impulses[i];
+			ImpulseExpireFrames[NumKept] = ImpulseExpireFrames[i];
+			NumKept++;
+		}
+	}
+
+	Impulses.SetNum(NumKept, EAllowShrinking::No);
+	ImpulseExpireFrames.SetNum(NumKept, EAllowShrinking::No);
+}
+
+TStatId UChainSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UChainSimulationSubsystem, STATGROUP_Tickables);
+}
+
+void UChainSimulationSubsystem::RegisterChain(UChainComponent* Chain)
+{
+	if (! Chain) return;
+
+	Chains.AddUnique(Chain);
+}
+
+void UChainSimulationSubsystem::UnregisterChain(UChainComponent* Chain)
+{
+	Chains.RemoveSingleSwap(Chain);
+}
+
+void UChainSimulationSubsystem::AddQueryChain(UChainComponent* Chain)
+{
+	if (! Chain) return;
+
+	QueryChains.AddUnique(Chain);
+	QueryGridFrame = MAX_uint64;
+}
+
+void UChainSimulationSubsystem::RemoveQueryChain(UChainComponent* Chain)
+{
+	if (QueryChains.RemoveSingleSwap(Chain) > 0)
+	{
+		QueryGridFrame = MAX_uint64;
+	}
+}
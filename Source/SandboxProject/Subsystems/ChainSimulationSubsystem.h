@@ -0,0 +1,247 @@
+// This is Sandbox Project.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SandboxProject/Components/ChainForceField.h"
+#include "SandboxProject/Components/ChainSpatialHash.h"
+#include "ChainSimulationSubsystem.generated.h"
+
+class UChainComponent;
+
+/**
+ * World subsystem that steps every registered UChainComponent in one batch.
+ *
+ * Each tick is split in three phases:
+ *  - a serial head on the game thread that reads attachment transforms and decides which chains step,
+ *  - a single ParallelFor that runs gravity and the constraint solver of all stepping chains on worker threads,
+ *    followed by chain to chain collision against one spatial hash of the points of all colliding chains,
+ *  - a short serial tail on the game thread for collision, aggregated events, then instance and attachment updates.
+ *
+ * Before the head, the significance manager is updated with the local player viewpoints, which selects
+ * the level of detail of every chain.
+ *
+ * The subsystem also owns the force fields of the world. Chains gather the fields overlapping their bounds
+ * once per frame in the serial head, through a uniform grid of the bounded fields, and sample them in the solver.
+ *
+ * Only game and PIE worlds are supported, chains in editor worlds keep ticking on their own.
+ */
+UCLASS()
+class SANDBOXPROJECT_API UChainSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Adds a chain to the batched simulation. The chain stops ticking on its own.
+	 *
+	 * @param Chain The chain component to simulate.
+	 */
+	void RegisterChain(UChainComponent* Chain);
+
+	/**
+	 * Removes a chain from the batched simulation.
+	 *
+	 * @param Chain The chain component to remove.
+	 */
+	void UnregisterChain(UChainComponent* Chain);
+
+	/**
+	 * Makes a chain reachable by area queries such as ApplyRadialForceToChains, whether it is batched or not.
+	 *
+	 * @param Chain The chain component to add.
+	 */
+	void AddQueryChain(UChainComponent* Chain);
+
+	/**
+	 * Removes a chain from the area queries.
+	 *
+	 * @param Chain The chain component to remove.
+	 */
+	void RemoveQueryChain(UChainComponent* Chain);
+
+	/**
+	 * Applies a force to every chain segment inside a sphere, e.g. for explosions and wind volumes.
+	 * Candidate chains are found in a uniform grid of the chain bounds, only those overlapping the sphere have their points tested.
+	 *
+	 * @param Origin The world space center of the sphere.
+	 * @param Radius The radius of the sphere.
+	 * @param Force The force applied to the affected points.
+	 * @return The number of affected chains.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	int32 ApplyRadialForceToChains(FVector Origin, float Radius, FVector Force);
+
+	/**
+	 * Registers a force field that accelerates every chain point inside it until it is removed.
+	 *
+	 * @param Field The force field, its direction is normalized.
+	 * @return The handle of the field, to update or remove it.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	int32 AddForceField(const FChainForceField& Field);
+
+	/**
+	 * Replaces a registered force field, e.g. to move it or to change its strength.
+	 *
+	 * @param Handle The handle returned by AddForceField.
+	 * @param Field The new force field.
+	 * @return True if the handle names a registered field.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	bool UpdateForceField(int32 Handle, const FChainForceField& Field);
+
+	/**
+	 * Removes a registered force field.
+	 *
+	 * @param Handle The handle returned by AddForceField.
+	 * @return True if the field was removed.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	bool RemoveForceField(int32 Handle);
+
+	/**
+	 * Changes the velocity of every chain point inside a sphere once, e.g. for explosions.
+	 * Chains apply the impulse on their next step, sleeping chains wake up for it.
+	 *
+	 * @param Origin The world space center of the sphere.
+	 * @param Radius The radius of the sphere.
+	 * @param Strength The velocity change away from the origin in cm/s, negative to pull toward it.
+	 * @param bFalloff Whether the impulse fades out linearly toward the radius.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Chain")
+	void AddRadialImpulseToChains(FVector Origin, float Radius, float Strength, bool bFalloff = true);
+
+	/**
+	 * @return True if any force field or impulse is registered.
+	 */
+	FORCEINLINE bool HasForceFields() const { return ForceFields.Num() > 0 || Impulses.Num() > 0; }
+
+	/**
+	 * Collects the force fields that reach into a box, e.g. the bounds of a chain.
+	 *
+	 * @param Bounds The world space box.
+	 * @param OutFields Receives the overlapping continuous fields, reset first.
+	 * @param OutImpulses Receives the overlapping impulses newer than AppliedImpulseSerial, appended.
+	 * @param AppliedImpulseSerial The serial of the last impulse seen by the caller, updated to the latest one.
+	 */
+	void GatherForceFields(const FBox& Bounds, TArray<FChainForceField>& OutFields, TArray<FChainForceField>& OutImpulses, uint32& AppliedImpulseSerial) const;
+
+	/**
+	 * @return All chains currently simulated by this subsystem.
+	 */
+	FORCEINLINE const TArray<TObjectPtr<UChainComponent>>& GetChains() const { return Chains; }
+
+private:
+	/**
+	 * Updates the significance manager of the world with the viewpoints of the local players.
+	 */
+	void UpdateSignificance();
+
+	/**
+	 * Broadcasts the pending collide, sound and break events of every chain within Chain.MaxEventsPerFrame.
+	 * Chains that did not step this frame, e.g. sleeping or frozen ones, still send the events they held back.
+	 */
+	void DispatchChainEvents();
+
+	/**
+	 * Builds the collision world from every chain with bChainCollision and pushes the stepping ones apart,
+	 * within Chain.MaxChainCollisionTests.
+	 */
+	void ResolveChainCollision();
+
+	/**
+	 * Rebuilds the grid of bounded force fields after fields were added, moved or removed.
+	 */
+	void RebuildForceFieldGrid() const;
+
+	/**
+	 * Drops the impulses that every stepping chain had the chance to apply.
+	 */
+	void ExpireImpulses();
+
+	/**
+	 * Rebuilds the grid of the query chain bounds, at most once per frame.
+	 */
+	void UpdateQueryGrid();
+
+	/** Every chain registered with this world. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UChainComponent>> Chains;
+
+	/** Chains that step this frame, rebuilt every tick without reallocating. */
+	TArray<UChainComponent*> SteppingChains;
+
+	/** Viewpoints of the local players, rebuilt every tick without reallocating. */
+	TArray<FTransform> SignificanceViewpoints;
+
+	/** Scratch buffer for the points affected by area forces. */
+	TArray<int32> AffectedPoints;
+
+	/** Every chain of the world reachable by area queries, batched or ticking on its own. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UChainComponent>> QueryChains;
+
+	/** Indices in QueryChains of the chains overlapping each grid cell. */
+	TMap<FIntVector, TArray<int32>> QueryChainCells;
+
+	/** Indices in QueryChains of the chains covering too many cells, tested by every query. */
+	TArray<int32> GlobalQueryChains;
+
+	/** Scratch buffer for the chain indices found in the grid. */
+	TArray<int32> GatheredQueryChains;
+
+	/** Frame QueryChainCells was built in, MAX_uint64 if it is out of date. */
+	uint64 QueryGridFrame = MAX_uint64;
+
+	/** Points of all colliding chains, rebuilt every tick into the same arena. */
+	FChainCollisionWorld ChainCollisionWorld;
+
+	/** Stepping chains taking part in chain to chain collision, rebuilt every tick without reallocating. */
+	TArray<UChainComponent*> CollidingChains;
+
+	/** Index in ChainCollisionWorld of each chain in CollidingChains. */
+	TArray<int32> CollidingChainIndices;
+
+	/** Chains with pending events in dispatch order, rebuilt every tick without reallocating. */
+	TArray<UChainComponent*> EventChains;
+
+	/** Index in Chains of each chain in EventChains. */
+	TArray<int32> EventChainIndices;
+
+	/** Position in Chains where the next event dispatch starts. */
+	int32 EventCursor = 0;
+
+	/** Registered force fields by handle. */
+	TMap<int32, FChainForceField> ForceFields;
+
+	/** Pending one-shot impulses, oldest first. */
+	TArray<FChainForceField> Impulses;
+
+	/** Frame the impulse of the same index is dropped in, after every registered chain stepped once. */
+	TArray<uint64> ImpulseExpireFrames;
+
+	/** Handles of the bounded fields overlapping each grid cell. */
+	mutable TMap<FIntVector, TArray<int32>> ForceFieldCells;
+
+	/** Handles of the fields tested against every box: unbounded fields and fields covering too many cells. */
+	mutable TArray<int32> GlobalForceFields;
+
+	/** Scratch buffer for the handles found in the grid. */
+	mutable TArray<int32> GatheredForceFields;
+
+	/** Whether ForceFieldCells is out of date. */
+	mutable bool bForceFieldGridDirty = false;
+
+	/** Handle of the next added force field. */
+	int32 NextForceFieldHandle = 1;
+
+	/** Serial number of the last added impulse. */
+	uint32 LastImpulseSerial = 0;
+};